@@ -29,7 +29,7 @@ double pevapotranspiration_combination_method(pet_model *model)
   double gamma;
   double von_karman_constant_squared=(double)KV2;  // a constant equal to 0.41 squared
 
-  calculate_intermediate_variables(model);
+  PET_TIME_STAGE(model, PET_TIMING_INTERMEDIATE_VARIABLES, calculate_intermediate_variables(model));
 
   liquid_water_density_kg_per_m3 = model->inter_vars.liquid_water_density_kg_per_m3;
   water_latent_heat_of_vaporization_J_per_kg=model->inter_vars.water_latent_heat_of_vaporization_J_per_kg;
@@ -43,27 +43,21 @@ double pevapotranspiration_combination_method(pet_model *model)
   delta=slope_sat_vap_press_curve_Pa_s;
   gamma=psychrometric_constant_Pa_per_C;
 
-  if(model->pet_options.use_combination_method==TRUE)
-    lambda_pet=0.0;
-  if( (model->pet_options.use_aerodynamic_method == FALSE ) && (model->pet_options.use_penman_monteith_method==FALSE) )
-  {
-    // This is equation 3.5.9 from Chow, Maidment, and Mays textbook.
-    lambda_pet=model->pet_forcing.net_radiation_W_per_sq_m;
-    radiation_balance_pevapotranspiration_rate_m_per_s=lambda_pet/
-                                        (liquid_water_density_kg_per_m3*water_latent_heat_of_vaporization_J_per_kg);
-    mass_flux = 0.622*von_karman_constant_squared*moist_air_density_kg_per_m3*      // kg per sq. meter per sec.
-                vapor_pressure_deficit_Pa*model->pet_forcing.wind_speed_m_per_s/
-                (model->pet_forcing.air_pressure_Pa*
-                pow(log(model->pet_params.wind_speed_measurement_height_m/model->pet_params.zero_plane_displacement_height_m),2.0));
+  // This is equation 3.5.9 from Chow, Maidment, and Mays textbook.
+  lambda_pet=model->pet_forcing.net_radiation_W_per_sq_m;
+  radiation_balance_pevapotranspiration_rate_m_per_s=lambda_pet/
+                                      (liquid_water_density_kg_per_m3*water_latent_heat_of_vaporization_J_per_kg);
+  mass_flux = 0.622*von_karman_constant_squared*moist_air_density_kg_per_m3*      // kg per sq. meter per sec.
+              vapor_pressure_deficit_Pa*model->pet_forcing.wind_speed_m_per_s/
+              (model->pet_forcing.air_pressure_Pa*
+              model->derived_params.aerodynamic_log_squared);
 
-    aerodynamic_method_pevapotranspiration_rate_m_per_s=mass_flux/liquid_water_density_kg_per_m3;
-  }
-  {
-    // This is equation 3.5.26 from Chow, Maidment, and Mays textbook
-    instantaneous_pet_rate_m_per_s=
-                      delta/(delta+gamma)*radiation_balance_pevapotranspiration_rate_m_per_s+
-                      gamma/(delta+gamma)*aerodynamic_method_pevapotranspiration_rate_m_per_s;
-  }
+  aerodynamic_method_pevapotranspiration_rate_m_per_s=mass_flux/liquid_water_density_kg_per_m3;
+
+  // This is equation 3.5.26 from Chow, Maidment, and Mays textbook
+  instantaneous_pet_rate_m_per_s=
+                    delta/(delta+gamma)*radiation_balance_pevapotranspiration_rate_m_per_s+
+                    gamma/(delta+gamma)*aerodynamic_method_pevapotranspiration_rate_m_per_s;
   return (instantaneous_pet_rate_m_per_s);
 }
 
@@ -34,14 +34,10 @@ double pevapotranspiration_energy_balance_method(pet_model *model)
   // We need this in all options except for aerodynamic or Penman-Monteith methods.
   // Radiation balance is the simplest method.  Involves only radiation calculations, no aerodynamic calculations.
 
-  lambda_pet=0.0;
-  if( (model->pet_options.use_aerodynamic_method == FALSE ) && (model->pet_options.use_penman_monteith_method==FALSE) )
-  {
-    // This is equation 3.5.9 from Chow, Maidment, and Mays textbook.
-    lambda_pet=model->pet_forcing.net_radiation_W_per_sq_m;
-    radiation_balance_pevapotranspiration_rate_m_per_s=lambda_pet/
-                                  (liquid_water_density_kg_per_m3*water_latent_heat_of_vaporization_J_per_kg);
-  }
+  // This is equation 3.5.9 from Chow, Maidment, and Mays textbook.
+  lambda_pet=model->pet_forcing.net_radiation_W_per_sq_m;
+  radiation_balance_pevapotranspiration_rate_m_per_s=lambda_pet/
+                                (liquid_water_density_kg_per_m3*water_latent_heat_of_vaporization_J_per_kg);
   return(radiation_balance_pevapotranspiration_rate_m_per_s);
 }
 
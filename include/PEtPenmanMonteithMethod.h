@@ -36,7 +36,7 @@ double pevapotranspiration_penman_monteith_method(pet_model *model)
   double delta;
   double gamma;
 
-  calculate_intermediate_variables(model);
+  PET_TIME_STAGE(model, PET_TIMING_INTERMEDIATE_VARIABLES, calculate_intermediate_variables(model));
 
   liquid_water_density_kg_per_m3 = model->inter_vars.liquid_water_density_kg_per_m3;
   water_latent_heat_of_vaporization_J_per_kg=model->inter_vars.water_latent_heat_of_vaporization_J_per_kg;
@@ -50,10 +50,7 @@ double pevapotranspiration_penman_monteith_method(pet_model *model)
   delta=slope_sat_vap_press_curve_Pa_s;
   gamma=psychrometric_constant_Pa_per_C;
 
-  if(model->pet_options.use_penman_monteith_method==TRUE)
-  {
-    lambda_pet = penman_monteith_pet_calculation(delta,gamma,moist_air_density_kg_per_m3,vapor_pressure_deficit_Pa,model);
-  }
+  lambda_pet = penman_monteith_pet_calculation(delta,gamma,moist_air_density_kg_per_m3,vapor_pressure_deficit_Pa,model);
 
   instantaneous_pet_rate_m_per_s= lambda_pet/(liquid_water_density_kg_per_m3*water_latent_heat_of_vaporization_J_per_kg);
 
@@ -83,21 +80,12 @@ double penman_monteith_pet_calculation
   double pm_denominator;
   double aerodynamic_resistance_s_per_m;
 
-  // this method requires more calculations 
-  if(is_fabs_less_than_eps(model->pet_params.vegetation_height_m,1.0e-06)==TRUE)
-  {
-    // the vegetation height was not specified.  TODO should warn??
-    fprintf(stderr,"WARNING: Vegetation height not specified in the Penman-Monteith routine.  Using 0.5m.\n");
-    model->pet_params.vegetation_height_m=0.5;  // use a reasonable assumed value
-  }
-  
-  // use approximations from UN FAO: http://www.fao.org/3/X0490E/x0490e06.htm#aerodynamic%20resistance%20(ra)
-  //model->pet_params.zero_plane_displacement_height_m=2.0/3.0*model->pet_params.vegetation_height_m; //wwu
-  //model->pet_params.momentum_transfer_roughness_length_m=0.123*model->pet_params.vegetation_height_m; //wwu
-  model->pet_params.momentum_transfer_roughness_length_m=0.1845*model->pet_params.zero_plane_displacement_height_m; //wwu 
-  model->pet_params.heat_transfer_roughness_length_m=0.1*model->pet_params.momentum_transfer_roughness_length_m;
-
-  aerodynamic_resistance_s_per_m = calculate_aerodynamic_resistance(model);
+  // the vegetation height check and the FAO roughness length approximations
+  // (http://www.fao.org/3/X0490E/x0490e06.htm#aerodynamic%20resistance%20(ra)) are done once, by
+  // compute_derived_params_pet(), and kept in model->derived_params.
+
+  PET_TIME_STAGE(model, PET_TIMING_AERODYNAMIC_RESISTANCE,
+                 aerodynamic_resistance_s_per_m = calculate_aerodynamic_resistance(model));
 
   // all the ingredients have been prepared.  Make Penman-Monteith soufle...
   // from: http://www.fao.org/3/X0490E/x0490e06.htm#aerodynamic%20resistance%20(ra)
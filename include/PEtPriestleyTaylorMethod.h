@@ -28,7 +28,7 @@ double pevapotranspiration_priestley_taylor_method(pet_model *model)
   double delta;
   double gamma;
 
-  calculate_intermediate_variables(model);
+  PET_TIME_STAGE(model, PET_TIMING_INTERMEDIATE_VARIABLES, calculate_intermediate_variables(model));
 
   liquid_water_density_kg_per_m3 = model->inter_vars.liquid_water_density_kg_per_m3;
   water_latent_heat_of_vaporization_J_per_kg=model->inter_vars.water_latent_heat_of_vaporization_J_per_kg;
@@ -42,14 +42,10 @@ double pevapotranspiration_priestley_taylor_method(pet_model *model)
   delta=slope_sat_vap_press_curve_Pa_s;
   gamma=psychrometric_constant_Pa_per_C;
 
-  lambda_pet=0.0;
-  if( (model->pet_options.use_aerodynamic_method == FALSE ) && (model->pet_options.use_penman_monteith_method==FALSE) )
-  {
-    // This is equation 3.5.9 from Chow, Maidment, and Mays textbook.
-    lambda_pet=model->pet_forcing.net_radiation_W_per_sq_m;
-    radiation_balance_pevapotranspiration_rate_m_per_s=lambda_pet/
-                                        (liquid_water_density_kg_per_m3*water_latent_heat_of_vaporization_J_per_kg);
-  }
+  // This is equation 3.5.9 from Chow, Maidment, and Mays textbook.
+  lambda_pet=model->pet_forcing.net_radiation_W_per_sq_m;
+  radiation_balance_pevapotranspiration_rate_m_per_s=lambda_pet/
+                                      (liquid_water_density_kg_per_m3*water_latent_heat_of_vaporization_J_per_kg);
   instantaneous_pet_rate_m_per_s=1.3*delta/(delta+gamma)*radiation_balance_pevapotranspiration_rate_m_per_s;
   return(instantaneous_pet_rate_m_per_s);
 }
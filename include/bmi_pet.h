@@ -8,6 +8,7 @@ extern "C" {
 #include "bmi.h"
 #include "pet.h"
 
+// Separate instances can be used from separate threads at the same time, see THREAD SAFETY in pet.h
 Bmi* register_bmi_pet(Bmi *model);
 
 pet_model * new_bmi_pet();
@@ -18,6 +19,31 @@ int read_file_line_counts_pet(const char* file_name,
                                  int* max_line_length);
 int read_init_config_pet(pet_model* model, const char* config_file);
 
+/*
+    Extension to BMI for couplers that move forcing every time step: resolve a variable name to a handle once, then
+    get and set its value by handle without any string work.  Handles are the same for every PET instance.
+    pet_resolve_var returns -1 if there is no input or output variable called name.
+*/
+int pet_resolve_var(Bmi *self, const char *name);
+int pet_get_by_handle(Bmi *self, int handle, void *dest);
+int pet_set_by_handle(Bmi *self, int handle, const void *src);
+
+/*
+    Extension to BMI that sets all seven forcing inputs of a time step in one call, in place of seven set_value calls.
+    The struct has no padding, so an array of 7 doubles in this order can be passed as well.
+*/
+typedef struct pet_forcing_inputs {
+    double incoming_longwave_W_per_m2;      // land_surface_radiation~incoming~longwave__energy_flux
+    double incoming_shortwave_W_per_m2;     // land_surface_radiation~incoming~shortwave__energy_flux
+    double surface_pressure_Pa;             // land_surface_air__pressure
+    double specific_humidity_2m_kg_per_kg;  // atmosphere_air_water~vapor__relative_saturation
+    double air_temperature_2m_K;            // land_surface_air__temperature
+    double u_wind_speed_10m_m_per_s;        // land_surface_wind__x_component_of_velocity
+    double v_wind_speed_10m_m_per_s;        // land_surface_wind__y_component_of_velocity
+} pet_forcing_inputs;
+
+int pet_set_forcing(Bmi *self, const pet_forcing_inputs *forcing);
+
 #if defined(__cplusplus)
 }
 #endif
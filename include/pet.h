@@ -5,6 +5,7 @@
 #include <math.h>
 #include <string.h>
 #include <float.h>  // JG EDIT
+#include <stddef.h>
 
 #define TRUE  1
 #define FALSE 0
@@ -14,6 +15,17 @@
 #define TK  273.15     //  temperature in Kelvin at zero degree Celcius
 #define SB  5.67e-08   //  stefan_boltzmann_constant in units of W/m^2/K^4
 
+// bits of pet_model.warnings_issued, for warnings from the per time step calculations that are printed once
+#define PET_WARNING_TINY_MOMENTUM_ROUGHNESS  0x1
+#define PET_WARNING_TINY_HEAT_ROUGHNESS      0x2
+
+// THREAD SAFETY: the library keeps no mutable global or static state, everything an instance uses hangs off its own
+// pet_model (allocated zeroed by new_bmi_pet).  Different instances may be initialized, updated, read, written and
+// finalized from different threads at the same time.  One instance must not be used by two threads at once.  An
+// instance streaming its forcing with forcing_prefetch=1 has a helper thread of its own that reads only its forcing
+// file, it is started by Initialize and joined by Finalize.
+// Warnings go to stderr with fprintf, which locks the stream for each call.
+
 // NOTE: SET YOUR EDIT WINDOW TO 120 CHARACTER WIDTH TO READ THIS CODE IN ITS ENTIRETY.
 
 //#####################################
@@ -127,6 +139,22 @@ struct pevapotranspiration_params
   int    day_of_year;                              // could be used to adjust canopy resistance for seasonality
 };
 
+// constants that depend only on pevapotranspiration_params, pet_method and yes_aorc.  Computed once by pet_setup()
+// so that the per time step calculations neither repeat the logarithms nor write back into pet_params.
+struct pevapotranspiration_derived_params
+{
+  // element NAME                                    DESCRIPTION
+  //____________________________________________________________________________________________________________________
+  double wind_speed_height_scale;                  // AORC 10 m wind to 2 m, log(2/d)/log(zm/d).  1.0 without AORC
+  double wind_speed_measurement_height_m;          // zm the methods see, 2.0 [m] once the AORC wind is converted
+  double humidity_measurement_height_m;            // zh, defaulted to 2.0 [m] if unknown
+  double zero_plane_displacement_height_m;         // d, clamped to 2/3 zh for the aerodynamic resistance [m]
+  double momentum_transfer_roughness_length_m;     // zom, FAO approximation for Penman-Monteith, else the parameter
+  double heat_transfer_roughness_length_m;         // zoh, FAO approximation for Penman-Monteith, else the parameter
+  double aerodynamic_log_squared;                  // log(zm/d)^2 of the aerodynamic and combination methods
+  double aerodynamic_resistance_log_product;       // log((zm-d)/zom)*log((zh-d)/zoh), ra times k^2 uz [-]
+};
+
 struct pevapotranspiration_forcing
 {
   // element NAME                          DESCRIPTION                                                                  
@@ -172,6 +200,7 @@ struct solar_radiation_options
   // element NAME                          DESCRIPTION
   //____________________________________________________________________________________________________________________
   int cloud_base_height_known;   // set this to TRUE to use the default values from the Bras textbook.
+  int cache_solar_geometry;      // set to TRUE to tabulate the sun position for the site at setup, see solar_cache
 };
 
 struct solar_radiation_parameters
@@ -196,6 +225,26 @@ struct solar_radiation_results
   double solar_local_hour_angle_degrees;             // local hour angle (deg.) to the sun, negative=a.m., positive=p.m.
 };
 
+struct solar_geometry
+{
+  // element NAME                          DESCRIPTION
+  //____________________________________________________________________________________________________________________
+  double solar_elevation_angle_radians;    // alpha, height of the sun above (+) or below (-) horizon
+  double sin_solar_elevation_angle;        // sin(alpha)
+  double solar_azimuth_angle_radians;      // azimuth pointing towards the sun (0-2 pi)
+  double solar_local_hour_angle_radians;   // tau, negative=a.m., positive=p.m.
+  double clear_sky_radiation_W_per_sq_m;   // Ic, on a plane perpendicular to the earth-sun line, 0 if alpha <= 0
+};
+
+struct solar_geometry_cache  // calculate_solar_geometry() for every day of year and whole hour of zulu time
+{
+  double latitude_degrees;               // the site and turbidity the table was built for
+  double longitude_degrees;
+  double site_elevation_m;
+  double atmospheric_turbidity_factor;
+  struct solar_geometry table[366][24];  // [day_of_year-1][zulu hour], about 350 kB
+};
+
 struct intermediate_vars
 {
   // element NAME                       DESCRIPTION
@@ -211,6 +260,24 @@ struct intermediate_vars
   //double water_latent_heat_of_vaporization_J_per_kg;
   double psychrometric_constant_Pa_per_C;      // gamma
 };
+struct pet_aggregates  // PET depth totals behind the daily, monthly and cumulative output variables, see pet.c
+{
+  double daily_m;                       // PET depth of the last complete UTC day
+  double monthly_m;                     // of the last complete calendar month
+  double cumulative_m;                  // since Initialize
+  double day_m, day_compensation_m;     // compensated sums of the day and month in progress
+  double month_m, month_compensation_m;
+  double cumulative_compensation_m;
+};
+
+#define PET_TIMING_N_STAGES 6
+struct pet_timing  // time spent in each stage of run_pet, counted when built with PET_TIMING, see pet_timing.h
+{
+  double ns[PET_TIMING_N_STAGES];      // wall clock nanoseconds
+  double cycles[PET_TIMING_N_STAGES];  // CPU timestamp counter ticks, 0 where there is no such counter
+  double calls[PET_TIMING_N_STAGES];
+};
+
 struct bmi
 {
   /*    
@@ -229,14 +296,29 @@ struct bmi
   int is_forcing_from_bmi;
 };
 
+struct pet_forcing_block  // the single allocation (or mapped binary file) holding the forcing_data_* columns
+{
+  double* base;             // column c, in pet_forcing_column order (pet_forcing.h), starts at base + c*column_stride
+  long    first_row;        // timestep of row 0, not 0 only for a streamed window (forcing_window_steps > 0)
+  long    n_rows;           // rows of forcing held, the columns have spare zeroed rows after them
+  long    column_stride;    // doubles from the start of one column to the next, 64 bytes apart at least
+};
+
 struct pet_model{
   
   // FLAGS
   int yes_aorc; // if TRUE then using AORC forcing data- if FALSE then we must calculate incoming short/longwave rad.
   int yes_wrf;  // if TRUE then we get radiation winds etc. from WRF output.  TODO not implemented.
   int pet_method;
+  double (*pet_method_kernel)(struct pet_model *model);  // bound from pet_method by pet_setup(), run once per step
   double pet_m_per_s;
+  struct pet_aggregates aggregates;   // daily, monthly and cumulative PET depth, added to by each Update
+  struct pet_timing timing;           // per stage run time, only counted when built with PET_TIMING
   char* forcing_file;
+  long  forcing_window_steps;         // rows of forcing_file held at a time, 0 reads the whole file at Initialize
+  int   forcing_prefetch;             // read the next window of forcing_file on a helper thread, see pet_forcing.h
+  char* catchment_configs;            // file listing a config per catchment, for a vector grid instance (see bmi_pet.c)
+  struct pet_batch* vector_batch;     // the catchments of a vector grid instance, NULL for a single catchment
   // ***********************************************************
   // ******************* Dynamic allocations *******************
   // ***********************************************************
@@ -250,11 +332,16 @@ struct pet_model{
   double* forcing_data_air_temperature_2m_K;            // Air temparture at 2m height, K                         | TMP_2maboveground
   double* forcing_data_u_wind_speed_10m_m_per_s;        // U-component of Wind at 10m height, m/s                 | UGRD_10maboveground
   double* forcing_data_v_wind_speed_10m_m_per_s;        // V-component of Wind at 10m height, m/s                 | VGRD_10maboveground
+  struct pet_forcing_block forcing_block;  // where the arrays above point into, 64 byte aligned
+  void*  forcing_mapping;       // binary forcing file the arrays above point into, NULL when they are in the arena
+  size_t forcing_mapping_size;
+  struct pet_forcing_stream* forcing_stream;  // the open forcing file while forcing_window_steps > 0, else NULL
 
   struct aorc_forcing_data_pet aorc;
 
   struct pevapotranspiration_options pet_options;
   struct pevapotranspiration_params  pet_params;
+  struct pevapotranspiration_derived_params derived_params;  // filled by pet_setup(), read only while running
   struct pevapotranspiration_forcing pet_forcing;
   struct intermediate_vars inter_vars;
 
@@ -264,18 +351,39 @@ struct pet_model{
   struct solar_radiation_options    solar_options;
   struct solar_radiation_parameters solar_params;
   struct solar_radiation_results    solar_results;
+  struct solar_geometry_cache*      solar_cache;  // NULL unless solar_options.cache_solar_geometry is set
+
+  unsigned int warnings_issued;  // PET_WARNING_* bits of the warnings this instance has already printed
+
+  struct pet_arena*      arena;       // all the heap storage of the instance, see pet_arena.h
+  struct pet_arena_pool* arena_pool;  // where the arena comes from and goes back to, NULL for plain malloc/free
 
   struct bmi bmi;
 
 };
 typedef struct pet_model pet_model;
 
-extern void alloc_pet_model(pet_model *model);
+// create the memory arena of the instance now, rather than on its first allocation.  Returns 0, or -1 if out of memory.
+extern int alloc_pet_model(pet_model *model);
 
+// release all the storage of the instance, see pet_arena.h: its arena, the mapping of a binary forcing file and the
+// arrays of a vector grid.  The pointers to them are cleared, the other fields of the model are left as they are.
 extern void free_pet_model(pet_model *model);
 
 extern int run_pet(pet_model* model);
 
+// whole timeseries mode, see pet.c
+extern long run_pet_series(pet_model* model, long n_steps, double *pet_m_per_s_out);
+
+// add the PET of the step starting at bmi.current_time to the aggregates, before the time is advanced
+extern void aggregate_pet_step(pet_model* model);
+
+// whether the step starting at step_time_s (seconds since 1970) ends a UTC day and a calendar month
+extern void pet_step_ends_period(double step_time_s, double time_step_size_s, int *ends_day, int *ends_month);
+
+// add a PET depth (m) to the aggregates, closing the day and month in progress as flagged
+extern void accumulate_pet_depth(struct pet_aggregates *aggregates, double depth_m, int ends_day, int ends_month);
+
 void pet_setup(pet_model* model);
 void pet_unit_tests(pet_model* model);
 
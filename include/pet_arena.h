@@ -0,0 +1,63 @@
+#ifndef PET_ARENA_H
+#define PET_ARENA_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include "pet.h"
+
+//#####################################################################################################################
+// Per instance memory.
+//
+// Everything a PET instance allocates while it lives (config strings, forcing arrays, the solar geometry cache, the
+// catchments of a vector grid) comes from one pet_arena hanging off its pet_model, and is given back in one go by
+// free_pet_model() when the instance is finalized.  Nothing is freed piecewise.
+//
+// An arena is a list of blocks handed out front to back.  Allocations are zeroed and start on a 64 byte boundary.
+// Small ones share 64 KB blocks, large ones (a forcing column) get a block of their own.
+//
+// A pet_arena_pool keeps the arenas of finalized instances, blocks and all, up to a limit, and hands them to the next
+// instance that needs one, so that creating and destroying many instances does not go back to malloc each time.  Set
+// pet_model.arena_pool before Initialize to use one.  A pool is not locked: share it only between instances that are
+// created and finalized on the same thread (one pool per worker thread), and destroy it after all of them have been
+// finalized.
+//#####################################################################################################################
+
+#define PET_ARENA_ALIGNMENT  64
+#define PET_ARENA_BLOCK_SIZE (64*1024)
+
+typedef struct pet_arena pet_arena;
+typedef struct pet_arena_pool pet_arena_pool;
+
+// a new, empty arena, recycled from the pool if it has one (pool may be NULL).  Returns NULL if out of memory.
+extern pet_arena *pet_arena_create(pet_arena_pool *pool);
+
+// size bytes, zeroed and PET_ARENA_ALIGNMENT aligned, valid until the arena is destroyed.  NULL if out of memory.
+extern void *pet_arena_alloc(pet_arena *arena, size_t size);
+
+extern char *pet_arena_strdup(pet_arena *arena, const char *s);
+
+// bytes held in blocks by the arena, used or not
+extern size_t pet_arena_reserved_bytes(const pet_arena *arena);
+
+// release everything allocated from the arena: back to the pool it came from while the pool has room, else to free()
+extern void pet_arena_destroy(pet_arena *arena);
+
+// a pool that keeps up to max_arenas arenas for reuse
+extern pet_arena_pool *pet_arena_pool_create(int max_arenas);
+
+extern void pet_arena_pool_destroy(pet_arena_pool *pool);
+
+// pet_arena_alloc() and pet_arena_strdup() from the arena of a model, which is created (from model->arena_pool) the
+// first time it is needed.  The model must have started zeroed, as new_bmi_pet() leaves it.
+extern void *pet_model_alloc(pet_model *model, size_t size);
+
+extern char *pet_model_strdup(pet_model *model, const char *s);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // PET_ARENA_H
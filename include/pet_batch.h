@@ -0,0 +1,142 @@
+#ifndef PET_BATCH_H
+#define PET_BATCH_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include "pet.h"
+
+//#####################################################################################################################
+// Multi-catchment PET engine.
+//
+// A pet_batch holds N catchments that share one PET method, with every parameter, forcing value and intermediate
+// stored as its own contiguous array of length N (structure-of-arrays).  pet_batch_run() computes one timestep for
+// all N catchments as a handful of sweeps over those arrays, instead of N calls to run_pet() each chasing pointers
+// through a separate pet_model.  The arithmetic is the same as run_pet() with AORC forcing, so a catchment in a
+// batch produces the same PET as a pet_model configured the same way.
+//
+// Typical use:
+//   pet_batch_init(&batch, n, pet_method);
+//   for each catchment i:  pet_batch_set_catchment(&batch, i, model_i);   // model_i read from config + pet_setup()
+//   each timestep:         fill batch.forcing.*[i], then pet_batch_run(&batch), then read batch.pet_m_per_s[i]
+//   pet_batch_free(&batch);
+//
+// Only AORC forcing (yes_aorc=1) is supported.  The solar geometry diagnostics (solar_results) are not carried by
+// the batch, since with AORC forcing they do not feed into the PET calculation.
+//#####################################################################################################################
+
+struct pet_batch_params  // per catchment copies of pevapotranspiration_derived_params and surface_radiation_params
+{
+  double *wind_speed_height_scale;
+  double *heat_transfer_roughness_length_m;
+  double *aerodynamic_log_squared;
+  double *aerodynamic_resistance_log_product;
+  double *surface_longwave_emissivity;
+  double *surface_shortwave_albedo;
+};
+
+struct pet_batch_forcing  // AORC forcing, same units as aorc_forcing_data_pet
+{
+  double *incoming_longwave_W_per_m2;
+  double *incoming_shortwave_W_per_m2;
+  double *surface_pressure_Pa;
+  double *specific_humidity_2m_kg_per_kg;
+  double *air_temperature_2m_K;
+  double *u_wind_speed_10m_m_per_s;
+  double *v_wind_speed_10m_m_per_s;
+};
+
+struct pet_batch_pet_forcing  // see struct pevapotranspiration_forcing
+{
+  double *net_radiation_W_per_sq_m;
+  double *air_temperature_C;
+  double *specific_humidity_2m_kg_per_kg;
+  double *air_pressure_Pa;
+  double *wind_speed_m_per_s;
+  double *canopy_resistance_sec_per_m;
+  double *water_temperature_C;
+  double *ground_heat_flux_W_per_sq_m;
+};
+
+struct pet_batch_surf_rad_forcing  // see struct surface_radiation_forcing
+{
+  double *incoming_shortwave_radiation_W_per_sq_m;
+  double *incoming_longwave_radiation_W_per_sq_m;
+  double *air_temperature_C;
+  double *relative_humidity_percent;
+  double *surface_skin_temperature_C;
+};
+
+struct pet_batch_inter_vars  // see struct intermediate_vars
+{
+  double *liquid_water_density_kg_per_m3;
+  double *water_latent_heat_of_vaporization_J_per_kg;
+  double *air_saturation_vapor_pressure_Pa;
+  double *air_actual_vapor_pressure_Pa;
+  double *vapor_pressure_deficit_Pa;
+  double *moist_air_gas_constant_J_per_kg_K;
+  double *moist_air_density_kg_per_m3;
+  double *slope_sat_vap_press_curve_Pa_s;
+  double *psychrometric_constant_Pa_per_C;
+};
+
+struct pet_batch_aggregates  // see struct pet_aggregates
+{
+  double *daily_m;
+  double *monthly_m;
+  double *cumulative_m;
+  double *day_m;
+  double *day_compensation_m;
+  double *month_m;
+  double *month_compensation_m;
+  double *cumulative_compensation_m;
+};
+
+// number of per-catchment arrays carved out of pet_batch.storage, see pet_batch_init()
+#define PET_BATCH_ARRAY_COUNT 44
+
+struct pet_batch
+{
+  long   n_catchments;
+  int    pet_method;                  // 1-5, same meaning as pet_model.pet_method, shared by every catchment
+
+  struct pet_batch_params           pet_params;
+  struct pet_batch_forcing          forcing;       // filled by the caller before each pet_batch_run()
+  struct pet_batch_pet_forcing      pet_forcing;
+  struct pet_batch_surf_rad_forcing surf_rad_forcing;
+  struct pet_batch_inter_vars       inter_vars;
+
+  double *pet_m_per_s;                // the result, one value per catchment
+  struct pet_batch_aggregates       aggregates;    // added to by pet_batch_aggregate()
+
+  double *storage;                    // single block backing every array above
+};
+typedef struct pet_batch pet_batch;
+
+// allocate the arrays for n catchments.  Returns 0 on success, -1 on failure.
+extern int pet_batch_init(pet_batch *batch, long n_catchments, int pet_method);
+
+// the same in storage the caller owns, zeroed and of PET_BATCH_ARRAY_COUNT*n_catchments doubles, such as the arena of
+// a pet_model.  Such a batch is not passed to pet_batch_free().
+extern int pet_batch_init_storage(pet_batch *batch, double *storage, long n_catchments, int pet_method);
+
+// copy the parameters of a configured pet_model (after read_init_config_pet and pet_setup) into slot i.
+// Returns -1 if the model does not use AORC forcing or uses a different PET method than the batch.
+extern int pet_batch_set_catchment(pet_batch *batch, long i, const pet_model *model);
+
+// compute one timestep of PET for every catchment in the batch.
+extern int pet_batch_run(pet_batch *batch);
+
+// add the PET of the step starting at step_time_s (seconds since 1970) to the aggregates of every catchment, as
+// aggregate_pet_step() does for a pet_model
+extern void pet_batch_aggregate(pet_batch *batch, double step_time_s, double time_step_size_s);
+
+// free the arrays of a batch from pet_batch_init()
+extern void pet_batch_free(pet_batch *batch);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // PET_BATCH_H
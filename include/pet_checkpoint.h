@@ -0,0 +1,70 @@
+#ifndef PET_CHECKPOINT_H
+#define PET_CHECKPOINT_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "pet.h"
+
+//#####################################################################################################################
+// Checkpoint and restart of the dynamic state of a PET instance.
+//
+// A checkpoint holds everything a run changes as it steps, so that a run restored from it carries on with bitwise the
+// same results as the run it was taken from:
+//   the bmi time fields (current_time_step, current_step, current_time), which also fix the forcing read position,
+//   aorc, pet_forcing, inter_vars, surf_rad_forcing, solar_results, pet_m_per_s, the PET depth aggregates, the
+//   warnings already issued and the stage timing;
+//   for a vector grid instance, every array of its pet_batch.
+// Parameters, options and the forcing itself are not in it: a checkpoint is restored into an instance initialized
+// from the same config, which with forcing_file=BMI or a streamed forcing file (forcing_window_steps) costs no
+// forcing ingest.  The instance can be one that has already run, so a forecast cycle can restart one instance from the
+// analysis state again and again.  A streamed forcing file is moved to the window of the restored step.
+//
+// Layout, all in the byte order of the machine that wrote it:
+//   pet_checkpoint_header   magic "PETCKPT", PET_CHECKPOINT_VERSION, the sizes of the structs saved and the pet
+//                           method, time step and catchments of the instance, the bytes and checksum (FNV-1a) of
+//                           the payload
+//   payload                 the structs above as they are in memory, then the batch arrays
+// Restoring refuses (printing why) a checkpoint with another magic, version, byte order or struct sizes, a damaged
+// payload, or one taken from an instance with another pet method, time step or number of catchments.
+//#####################################################################################################################
+
+#define PET_CHECKPOINT_MAGIC   "PETCKPT"
+#define PET_CHECKPOINT_VERSION 1
+
+typedef struct pet_checkpoint_header {
+  char     magic[8];
+  uint32_t version;
+  uint32_t byte_order;       // 0x01020304 as written
+  uint32_t struct_bytes[8];  // sizes of the structs in the payload, in the order they are saved
+  int32_t  pet_method;
+  int32_t  time_step_size_s;
+  int64_t  n_catchments;     // 0 for a single catchment instance
+  uint64_t payload_bytes;
+  uint64_t payload_checksum;
+} pet_checkpoint_header;
+
+// bytes a checkpoint of the model takes, header included
+extern size_t pet_checkpoint_size(const pet_model *model);
+
+// write a checkpoint of the model to buffer.  Returns the bytes written, or 0 (after printing why) if buffer_bytes is
+// less than pet_checkpoint_size().
+extern size_t pet_checkpoint_save(const pet_model *model, void *buffer, size_t buffer_bytes);
+
+// restore the model from a checkpoint of buffer_bytes bytes.  Returns 0, or -1 (after printing why) with the model
+// left as it was if the checkpoint does not fit the model, or with the forcing window not moved if a streamed forcing
+// file cannot be read.
+extern int pet_checkpoint_restore(pet_model *model, const void *buffer, size_t buffer_bytes);
+
+// the same through a file.  Return 0, or -1 (after printing why).
+extern int pet_checkpoint_save_file(const pet_model *model, const char *file_name);
+extern int pet_checkpoint_restore_file(pet_model *model, const char *file_name);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // PET_CHECKPOINT_H
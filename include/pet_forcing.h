@@ -0,0 +1,111 @@
+#ifndef PET_FORCING_H
+#define PET_FORCING_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "pet.h"
+
+//#####################################################################################################################
+// Loading of the forcing file named by forcing_file in the config.
+//
+// Two formats are read, told apart by the first bytes of the file:
+//
+// AORC csv, with the columns of forcing/cat-67_2015.csv:
+//   time,APCP_surface,DLWRF_surface,DSWRF_surface,PRES_surface,SPFH_2maboveground,TMP_2maboveground,
+//   UGRD_10maboveground,VGRD_10maboveground,precip_rate
+// The file is memory mapped and read in a single pass: line boundaries are found with memchr and the numbers are
+// parsed in place, so there is no per line copy or heap allocation.
+//
+// Binary columnar, written by pet_convert_forcing (src/main_convert_forcing.c): a pet_forcing_bin_header followed by
+// one column of doubles per variable, each starting on a 64 byte boundary.  The forcing_data_* arrays point straight
+// into the mapped file, nothing is parsed or copied.  Columns hold the values exactly as the csv reader produces them,
+// so both formats give identical results.  Numbers are in the byte order of the machine that wrote the file.
+//
+// Either way the columns end up in a single block described by pet_model.forcing_block: column c of the enum below
+// starts at base + c*column_stride, on a 64 byte boundary, and is followed by at least one spare row of zeros.  A csv
+// is read into one allocation from the arena of the model, a binary file is used in place.
+//
+// With forcing_window_steps = K > 0 in the config the file is streamed instead: it stays open and the block holds K
+// consecutive timesteps from forcing_block.first_row on, refilled by advance_forcing_window_pet() when the run steps
+// past its end.  Memory then stays at K rows however long the record is.  A csv is read through a fixed line buffer,
+// a binary file K rows per column with fseek/fread.  Values are the same as those of a whole file load.
+//
+// With forcing_prefetch = 1 as well (K defaults to 720 then), and a library built with PET_FORCING_PREFETCH (CMake
+// does when it finds pthreads), the stream gets a helper thread and a second block of K rows.  While the run uses one
+// block the helper reads the next K timesteps into the other, and advance_forcing_window_pet() swaps them, so a run
+// going forwards only waits on the file if it steps faster than the file is read.  Without PET_FORCING_PREFETCH the
+// key is ignored with a message and the windows are read in line.
+//#####################################################################################################################
+
+#define PET_FORCING_BIN_MAGIC     "PETFORC"   // 8 bytes with the terminating NUL
+#define PET_FORCING_BIN_VERSION   1
+#define PET_FORCING_BIN_ALIGNMENT 64
+
+// column order in the binary file
+enum pet_forcing_column {
+  PET_FORCING_TIME,                  // seconds since 1970
+  PET_FORCING_PRECIP,                // kg/m^2 per time step, precip_rate times time_step_size_s of the header
+  PET_FORCING_INCOMING_LONGWAVE,     // W/m^2
+  PET_FORCING_INCOMING_SHORTWAVE,    // W/m^2
+  PET_FORCING_SURFACE_PRESSURE,      // Pa
+  PET_FORCING_SPECIFIC_HUMIDITY,     // kg/kg
+  PET_FORCING_AIR_TEMPERATURE,       // K
+  PET_FORCING_U_WIND_SPEED,          // m/s at 10 m
+  PET_FORCING_V_WIND_SPEED,          // m/s at 10 m
+  PET_FORCING_N_COLUMNS
+};
+
+struct pet_forcing_bin_header {
+  char    magic[8];                                  // PET_FORCING_BIN_MAGIC
+  int32_t version;                                   // PET_FORCING_BIN_VERSION
+  int32_t n_columns;                                 // PET_FORCING_N_COLUMNS
+  int64_t n_rows;
+  double  start_time;                                // seconds since 1970 of the first row
+  double  time_step_size_s;                          // dt of the rows, the precip column is scaled by this
+  int64_t column_offset[PET_FORCING_N_COLUMNS];      // bytes from the start of the file, multiples of 64
+};
+
+// seconds since 1970-01-01 00:00:00 UTC of a proleptic Gregorian civil date and time, in integer arithmetic only.
+// Does not depend on the TZ of the process, and months are 1 to 12.
+extern int64_t civil_to_epoch_seconds_pet(long year, long month, long day, long hour, long minute, long second);
+
+// the civil date of a day number since 1970-01-01 (which is day 0), the inverse of civil_to_epoch_seconds_pet()
+extern void epoch_days_to_civil_pet(int64_t days, long *year, long *month, long *day);
+
+// parse a "YYYY-MM-DD hh:mm:ss" timestamp (fields may have fewer digits, the time part may be left out) starting at
+// s into seconds since 1970 UTC.  Returns a pointer just past the timestamp, or NULL if s does not start with one.
+extern const char *parse_timestamp_pet(const char *s, double *epoch_seconds);
+
+// parse_timestamp_pet() for a whole column of n timestamps, with the day number reused while the date part repeats,
+// as it does for 24 consecutive rows of hourly forcing.  Returns the number of timestamps that failed to parse
+// (those get 0.0).
+extern long parse_timestamp_column_pet(const char *const *timestamps, long n, double *epoch_seconds);
+
+// fill the model->forcing_data_* arrays for bmi.num_timesteps rows from a csv or binary forcing file.  If the file has
+// fewer rows than num_timesteps the last row is repeated; if num_timesteps is 0 it is set to the number of rows in the
+// file.  Sets bmi.current_time to the time of the first row.  Returns 0 on success, -1 (after printing why) if the
+// file cannot be read or holds no data rows.
+extern int read_aorc_forcing_file_pet(pet_model* model, const char* forcing_file);
+
+// with a streamed forcing file, load timesteps step .. step+forcing_window_steps-1 into the window (rows past the end
+// of the file repeat its last row).  Returns the row of the forcing_data_* arrays holding step: 0 after a refill, step
+// itself if the whole file is loaded, -1 (after printing why) if the file cannot be read.  Moving back is allowed, a
+// csv is then read again from its first row.
+extern long advance_forcing_window_pet(pet_model* model, long step);
+
+// write the bmi.num_timesteps rows of the model->forcing_data_* arrays as a binary columnar forcing file.
+// Returns 0 on success, -1 (after printing why) on failure, which includes a streamed forcing file.
+extern int write_forcing_binary_pet(const pet_model* model, const char* file_name);
+
+// close a streamed file, unmap a binary forcing file and clear the forcing_data_* pointers.  Arrays read from a csv are in the arena of the
+// model and go with it, see free_pet_model().
+extern void free_aorc_forcing_pet(pet_model* model);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // PET_FORCING_H
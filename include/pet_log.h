@@ -0,0 +1,50 @@
+#ifndef PET_LOG_H
+#define PET_LOG_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include <stdio.h>
+
+//#####################################################################################################################
+// Verbose output.
+//
+// The verbose key of the config (pet_model.bmi.verbose) is the runtime level: a message of level L is printed when
+// verbose >= L.  PET_LOG_MAX_LEVEL is the compile time level: messages above it are not built at all, the test of
+// verbose included, so a build with -DPET_LOG_MAX_LEVEL=0 has no logging left in Initialize, Update, run_pet or the
+// forcing ingest.  Without it every level is built, as before.  Errors are not verbose output and are always
+// printed.
+//
+//   PET_LOG(model, PET_LOG_DETAIL, "format", ...)     one printf
+//   if (PET_LOG_ON(model, PET_LOG_DETAIL)) { ... }    a block of them
+//#####################################################################################################################
+
+#define PET_LOG_INFO    1  // the PET of each step
+#define PET_LOG_DETAIL  2  // config values and the steps of Initialize and Update
+#define PET_LOG_DEBUG   3  // model state each step
+#define PET_LOG_TRACE   4
+#define PET_LOG_DUMP    5  // every row of the forcing
+
+#ifndef PET_LOG_MAX_LEVEL
+#define PET_LOG_MAX_LEVEL PET_LOG_DUMP
+#endif
+
+#if defined(__GNUC__)
+#define PET_LOG_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define PET_LOG_UNLIKELY(x) (x)
+#endif
+
+// a constant 0 when level is compiled out, so the compiler drops the test and the block with it
+#define PET_LOG_ON(model, level) \
+  ((level) <= PET_LOG_MAX_LEVEL && PET_LOG_UNLIKELY((model)->bmi.verbose >= (level)))
+
+#define PET_LOG(model, level, ...) \
+  do { if (PET_LOG_ON(model, level)) printf(__VA_ARGS__); } while (0)
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // PET_LOG_H
@@ -0,0 +1,87 @@
+#ifndef PET_OUTPUT_H
+#define PET_OUTPUT_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include "pet.h"
+#include "pet_batch.h"
+
+//#####################################################################################################################
+// Buffered output of PET time series, for drivers that run the model offline.
+//
+// A pet_output gathers the selected fields of every step of every catchment into a large buffer and writes it to
+// the file in bulk, so output costs a few big writes instead of several printf calls per step.
+//
+// Formats:
+//   PET_OUTPUT_CSV     a header line with the field names, then one line per record: the catchment index (only if
+//                      there is more than one catchment), then the fields.  Times are written as whole seconds, the
+//                      other fields with 10 significant digits.  Records are written in the order they are given.
+//   PET_OUTPUT_BINARY  raw little-endian doubles, no header, one record of the selected fields after another.
+//                      PET_OUTPUT_TIME_MAJOR: all catchments of step 0, then all catchments of step 1, and so on,
+//                      each step given for the catchments in order.
+//                      PET_OUTPUT_CATCHMENT_MAJOR: all n_steps steps of catchment 0, then those of catchment 1, and
+//                      so on, whatever order the records are given in.  Each catchment gets a slice of the buffer,
+//                      written to its place in the file with fseek whenever it fills.
+//
+// Fields are picked with the PET_OUTPUT_* bits below and are always written in the order of the bits.
+//
+// A pet_output is not locked, give each thread its own.  Errors are printed and returned as -1 (NULL from open).
+//#####################################################################################################################
+
+enum pet_output_format {
+  PET_OUTPUT_CSV,
+  PET_OUTPUT_BINARY
+};
+
+enum pet_output_layout {
+  PET_OUTPUT_TIME_MAJOR,
+  PET_OUTPUT_CATCHMENT_MAJOR       // binary only, needs n_steps
+};
+
+#define PET_OUTPUT_TIME                    0x01  // seconds since 1970 of the start of the step
+#define PET_OUTPUT_PET                     0x02  // water_potential_evaporation_flux, m/s
+#define PET_OUTPUT_NET_RADIATION           0x04  // W/m^2
+#define PET_OUTPUT_AIR_TEMPERATURE         0x08  // C
+#define PET_OUTPUT_WIND_SPEED              0x10  // m/s at the measurement height
+#define PET_OUTPUT_VAPOR_PRESSURE_DEFICIT  0x20  // Pa
+#define PET_OUTPUT_CUMULATIVE_DEPTH        0x40  // water_potential_evaporation_depth_cumulative, m
+#define PET_OUTPUT_N_FIELDS                7
+
+#define PET_OUTPUT_DEFAULT_BUFFER_BYTES    (4*1024*1024)
+
+typedef struct pet_output_options {
+  int          format;          // pet_output_format
+  int          layout;          // pet_output_layout
+  unsigned int fields;          // PET_OUTPUT_* bits, at least one
+  long         n_catchments;    // catchment indexes are 0 .. n_catchments-1
+  long         n_steps;         // steps per catchment, needed for PET_OUTPUT_CATCHMENT_MAJOR only
+  size_t       buffer_bytes;    // 0 for PET_OUTPUT_DEFAULT_BUFFER_BYTES
+} pet_output_options;
+
+typedef struct pet_output pet_output;
+
+// create (or truncate) file_name for output.  Returns NULL (after printing why) if the options are not valid or the
+// file cannot be opened.
+extern pet_output *pet_output_open(const char *file_name, const pet_output_options *options);
+
+// the selected fields of a model after the run of the step starting at step_time_s, as the next step of catchment
+extern int pet_output_write(pet_output *out, long catchment, double step_time_s, const pet_model *model);
+
+// the same for every catchment of a batch, catchment i of the output being item i of the batch
+extern int pet_output_write_batch(pet_output *out, double step_time_s, const pet_batch *batch);
+
+// n steps of a catchment from run_pet_series(): only PET_OUTPUT_TIME and PET_OUTPUT_PET can be selected
+extern int pet_output_write_series(pet_output *out, long catchment, double start_time_s, double time_step_size_s,
+                                   long n, const double *pet_m_per_s);
+
+// write what is left in the buffer and close the file.  Returns 0, or -1 if anything could not be written.
+extern int pet_output_close(pet_output *out);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // PET_OUTPUT_H
@@ -0,0 +1,31 @@
+#ifndef PET_SIMD_H
+#define PET_SIMD_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//#####################################################################################################################
+// Vector kernels over arrays of catchments (or timesteps).
+//
+// When the library is compiled for AVX-512 (__AVX512F__) or AVX2 (__AVX2__) these process 8 or 4 values per
+// instruction with a polynomial exponential accurate to about 1 ulp.  Otherwise they fall back to a scalar loop over
+// libm exp(), which gives exactly the same numbers as calc_air_saturation_vapor_pressure_Pa() and
+// calc_slope_of_air_saturation_vapor_pressure_Pa_per_C() in pet_tools.h.
+//#####################################################################################################################
+
+// saturation vapor pressure of air (Pa) and the slope of the saturation curve (Pa per C) for n air temperatures (C),
+// Chow, Maidment, and Mays eqns. 3.2.9 and 3.2.10, with a single exponential per element.  Either output may be NULL.
+extern void calc_air_saturation_vapor_pressure_and_slope_array(const double *air_temperature_C,
+                                                               double *air_sat_vap_press_Pa,
+                                                               double *slope_of_air_sat_vap_press_curve_Pa_per_C,
+                                                               long n);
+
+// name of the code path compiled into the kernels above: "avx512", "avx2" or "scalar"
+extern const char *pet_simd_kernel_name(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // PET_SIMD_H
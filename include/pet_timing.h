@@ -0,0 +1,91 @@
+#ifndef PET_TIMING_H
+#define PET_TIMING_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include "pet.h"
+
+//#####################################################################################################################
+// Per stage timing of run_pet.
+//
+// Built with -DPET_TIMING (CMake option PET_TIMING), every step adds the wall clock nanoseconds, CPU timestamp
+// counter ticks and one call to pet_model.timing for each stage it goes through.  The totals can be read through the
+// BMI output variables pet_stage_time_ns, pet_stage_cycle_count and pet_stage_call_count (one item per stage, in the
+// order below, on grid 1) and are printed by Finalize.  Without PET_TIMING the stages are not timed and cost nothing,
+// and neither the output variables nor grid 1 exist.
+//
+// The stages do not overlap: the method kernel is its own time, without the net radiation, intermediate variables
+// and aerodynamic resistance it calls.  A vector grid instance runs its catchments in one fused batch kernel, which
+// is all counted as the method kernel.  Counting costs two clock reads per stage of every step.
+//#####################################################################################################################
+
+enum pet_timing_stage {
+  PET_TIMING_FORCING,                  // the row of forcing found (and read, if streamed) and staged for the step
+  PET_TIMING_SOLAR_RADIATION,          // calculate_solar_radiation()
+  PET_TIMING_NET_RADIATION,            // calculate_net_radiation_W_per_sq_m()
+  PET_TIMING_INTERMEDIATE_VARIABLES,   // calculate_intermediate_variables()
+  PET_TIMING_AERODYNAMIC_RESISTANCE,   // calculate_aerodynamic_resistance()
+  PET_TIMING_METHOD                    // the PET method kernel
+};
+
+extern const char *pet_timing_stage_names[PET_TIMING_N_STAGES];
+
+// print the totals of a model, one line per stage that ran, under title
+extern void print_pet_timing(const pet_model *model, const char *title);
+
+#if defined(PET_TIMING)
+
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+typedef struct pet_timing_mark {
+  struct timespec wall;
+  uint64_t        cycles;
+} pet_timing_mark;
+
+static inline pet_timing_mark pet_timing_now(void)
+{
+  pet_timing_mark mark;
+  clock_gettime(CLOCK_MONOTONIC, &mark.wall);
+#if defined(__x86_64__) || defined(__i386__)
+  mark.cycles = __rdtsc();
+#else
+  mark.cycles = 0;
+#endif
+  return mark;
+}
+
+// add the time since start to a stage, and a call
+static inline void pet_timing_add(pet_model *model, int stage, pet_timing_mark start)
+{
+  pet_timing_mark end = pet_timing_now();
+  model->timing.ns[stage] += (double)(end.wall.tv_sec - start.wall.tv_sec) * 1.0e9 +
+                             (double)(end.wall.tv_nsec - start.wall.tv_nsec);
+  model->timing.cycles[stage] += (double)(end.cycles - start.cycles);
+  model->timing.calls[stage] += 1.0;
+}
+
+#define PET_TIMING_BEGIN(name)               pet_timing_mark name = pet_timing_now()
+#define PET_TIMING_END(model, stage, name)   pet_timing_add(model, stage, name)
+
+#else
+
+#define PET_TIMING_BEGIN(name)               do { } while (0)
+#define PET_TIMING_END(model, stage, name)   do { } while (0)
+
+#endif
+
+// run statement as one call of a stage
+#define PET_TIME_STAGE(model, stage, statement) \
+  do { PET_TIMING_BEGIN(pet_stage_start_); statement; PET_TIMING_END(model, stage, pet_stage_start_); } while (0)
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // PET_TIMING_H
@@ -15,6 +15,12 @@ double calculate_aerodynamic_resistance(pet_model *model);
 
 void calculate_solar_radiation(pet_model *model);
 
+void calculate_solar_geometry(pet_model *model, int day_of_year, int zulu_hour, struct solar_geometry *geometry);
+
+void build_solar_geometry_cache(pet_model *model);
+
+// needs inter_vars.air_saturation_vapor_pressure_Pa and inter_vars.slope_sat_vap_press_curve_Pa_s staged for
+// pet_forcing.air_temperature_C first, see calculate_intermediate_variables() below
 void calculate_intermediate_variables(pet_model *model);
 
 int is_fabs_less_than_eps(double a,double epsilon);  // returns TRUE iff fabs(a)<epsilon
@@ -23,9 +29,11 @@ double calc_air_saturation_vapor_pressure_Pa(double air_temperature_C);
 
 double calc_slope_of_air_saturation_vapor_pressure_Pa_per_C(double air_temperature_C);
 
+void calc_air_saturation_vapor_pressure_and_slope_Pa(double air_temperature_C, double *air_sat_vap_press_Pa,
+                                                     double *slope_of_air_sat_vap_press_curve_Pa_per_C);
+
 double calc_liquid_water_density_kg_per_m3(double water_temperature_C);
 
-int pet_method_int;
 
 //############################################################*
 // subroutine to calculate net radiation from all components  *
@@ -112,42 +120,15 @@ double calculate_net_radiation_W_per_sq_m(pet_model *model)
 //############################################################*
 double calculate_aerodynamic_resistance(pet_model *model)
 {
-  // define local variables to ease computations:
-  double wind_speed_measurement_height_m = model->pet_params.wind_speed_measurement_height_m;
-  double humidity_measurement_height_m = model->pet_params.humidity_measurement_height_m; // default =2.0 [m],
-  double zero_plane_displacement_height_m = model->pet_params.zero_plane_displacement_height_m;// depends on surface roughness [m],
-  double momentum_transfer_roughness_length_m = model->pet_params.momentum_transfer_roughness_length_m; // [m],
-  double heat_transfer_roughness_length_m = model->pet_params.heat_transfer_roughness_length_m;     // [m],
-  double wind_speed_m_per_s = model->pet_forcing.wind_speed_m_per_s;                    // [m s-1].
-
-  double ra,zm,zh,d,zom,zoh,k,uz;
+  double ra;
   double von_karman_constant_squared=KV2;  // this is dimensionless universal constant [-], K=0.41, squared.
 
-  // input sanity checks.
-  if(1.0e-06 >=wind_speed_measurement_height_m ) wind_speed_measurement_height_m=2.0;  // standard measurement height
-  if(1.0e-06 >=humidity_measurement_height_m )     humidity_measurement_height_m=2.0;  // standard measurement height
-  if(1.0e-06 >= momentum_transfer_roughness_length_m)  
-    fprintf(stderr,"momentum_transfer_roughness_length_m is tiny in calculate_aerodynamic_resistance().  Should not be tiny.\n");
-  if(1.0e-06 >= heat_transfer_roughness_length_m )  //warn.  Should not be tiny.
-    fprintf(stderr,"heat_transfer_roughness_length_m is tiny in calculate_aerodynamic_resistance().  Should not be tiny.\n");
-
-  // convert to smaller local variable names to keep equation readable 
-  zm=wind_speed_measurement_height_m;
-  zh=humidity_measurement_height_m; 
-  d= zero_plane_displacement_height_m;
-  zom=momentum_transfer_roughness_length_m;
-  zoh=heat_transfer_roughness_length_m;
-  uz=wind_speed_m_per_s;
-
+  // the heights and roughness lengths are sanity checked, and the logarithms of
+  // log((zm-d)/zom)*log((zh-d)/zoh) taken, once by compute_derived_params_pet().
   // here log is the natural logarithm.
-  // add a necessary condition for ra calculation 
-  // TODO: check zero displacement height (parsing from config_file?)
-  if (d >= zh) {
-    d = 2.0/3.0 * zh;
-  }
-  
-  ra=log((zm-d)/zom)*log((zh-d)/zoh)/(von_karman_constant_squared*uz);  // this is the equation for the aero. resist.
-                                                                      // from the FAO reference PET document.
+  ra=model->derived_params.aerodynamic_resistance_log_product/
+     (von_karman_constant_squared*model->pet_forcing.wind_speed_m_per_s);  // this is the equation for the aero. resist.
+                                                                           // from the FAO reference PET document.
 
   return(ra);
 }
@@ -181,6 +162,21 @@ double calc_slope_of_air_saturation_vapor_pressure_Pa_per_C(double air_temperatu
   return(slope_of_air_sat_vap_press_curve_Pa_per_C);
 }
 
+//#################################################################*
+// function to calculate both the saturation vapor pressure and    *
+// the slope of the saturation vapor pressure curve with a single  *
+// exponential.  Gives the same values as the two functions above. *
+// For arrays of temperatures see pet_simd.h.                      *
+//#################################################################*
+void calc_air_saturation_vapor_pressure_and_slope_Pa(double air_temperature_C, double *air_sat_vap_press_Pa,
+                                                     double *slope_of_air_sat_vap_press_curve_Pa_per_C)
+{
+  double air_sat_vap_press= 611.0*exp(17.27*air_temperature_C/(237.3+air_temperature_C));  // it is 237.3
+
+  *air_sat_vap_press_Pa=air_sat_vap_press;
+  *slope_of_air_sat_vap_press_curve_Pa_per_C=4098.0*air_sat_vap_press/pow((237.3+air_temperature_C),2.0);
+}
+
 //############################################################*
 // function to calculate density of liquid water by empirical *
 // equation, as a function of water temperature in C          *
@@ -220,11 +216,18 @@ double calc_liquid_water_density_kg_per_m3(double water_temperature_C)
 // F.L. Ogden, 2009, NOAA National Weather Service, 2020      /
 //############################################################/
 
-void calculate_solar_radiation(pet_model* model)
+//############################################################/
+// subroutine to calculate the position of the sun and the    /
+// clear sky solar radiation for a day of year and a whole    /
+// hour of zulu time.  Split out of calculate_solar_radiation /
+// so that it can be tabulated per site, see                  /
+// build_solar_geometry_cache().                              /
+//############################################################/
+void calculate_solar_geometry(pet_model *model, int day_of_year, int zulu_hour, struct solar_geometry *geometry)
 {
   double delta,r,equation_of_time_minutes,M,phi;
   double sinalpha,tau,alpha,cosalpha,azimuth;
-  double Io,Ic,kshort,Ips;
+  double Io,Ic;
   double b,fh1;
 
   // constants 
@@ -242,8 +245,8 @@ void calculate_solar_radiation(pet_model* model)
   double zulu_time_h;
   double optical_air_mass;
 
-  int pet_doy = model->surf_rad_forcing.day_of_year;
-  int pet_zulu_time = model->surf_rad_forcing.zulu_time;
+  int pet_doy = day_of_year;
+  int pet_zulu_time = zulu_hour;
 
   solar_constant_W_per_sq_m = 1361.6;     // Dudock de Wit et al. 2017 GRL, approx. avg. value
 
@@ -321,11 +324,11 @@ void calculate_solar_radiation(pet_model* model)
     azimuth=2.0*M_PI-azimuth; 
   }
 
-  model->solar_results.solar_elevation_angle_degrees=alpha*180.0/M_PI;      // convert to degrees 
-
-  model->solar_results.solar_azimuth_angle_degrees=azimuth*180.0/M_PI;      // convert to degrees  
-
-  model->solar_results.solar_local_hour_angle_degrees=tau*180.0/M_PI;       // convert to degrees 
+  geometry->solar_elevation_angle_radians=alpha;
+  geometry->sin_solar_elevation_angle=sinalpha;
+  geometry->solar_azimuth_angle_radians=azimuth;
+  geometry->solar_local_hour_angle_radians=tau;
+  geometry->clear_sky_radiation_W_per_sq_m=0.0;
 
   if(alpha>0.0)  // the sun is over the horizon 
   { 
@@ -343,6 +346,47 @@ void calculate_solar_radiation(pet_model* model)
     // note, atm_turbidity is equal to Tlk in Ineichen and Perez, 2002.
     Ic=b*Io*exp(-0.09*optical_air_mass*(model->surf_rad_forcing.atmospheric_turbidity_factor-1.0));  // clear sky radiation
 
+    geometry->clear_sky_radiation_W_per_sq_m=Ic;
+  }
+
+  return;
+}
+
+void calculate_solar_radiation(pet_model* model)
+{
+  struct solar_geometry computed;
+  const struct solar_geometry *geometry;
+  double Ic,kshort,Ips;
+
+  int pet_doy = model->surf_rad_forcing.day_of_year;
+  int pet_zulu_time = model->surf_rad_forcing.zulu_time;
+
+  // the tabulated sun position for this day and hour, if there is a cache built for this site and turbidity
+  geometry=NULL;
+  if(model->solar_cache!=NULL && 1<=pet_doy && pet_doy<=366 && 0<=pet_zulu_time && pet_zulu_time<=23 &&
+     model->solar_cache->latitude_degrees==model->solar_params.latitude_degrees &&
+     model->solar_cache->longitude_degrees==model->solar_params.longitude_degrees &&
+     model->solar_cache->site_elevation_m==model->solar_params.site_elevation_m &&
+     model->solar_cache->atmospheric_turbidity_factor==model->surf_rad_forcing.atmospheric_turbidity_factor)
+  {
+    geometry=&model->solar_cache->table[pet_doy-1][pet_zulu_time];
+  }
+  else
+  {
+    calculate_solar_geometry(model,pet_doy,pet_zulu_time,&computed);
+    geometry=&computed;
+  }
+
+  model->solar_results.solar_elevation_angle_degrees=geometry->solar_elevation_angle_radians*180.0/M_PI;  // convert to degrees 
+
+  model->solar_results.solar_azimuth_angle_degrees=geometry->solar_azimuth_angle_radians*180.0/M_PI;      // convert to degrees  
+
+  model->solar_results.solar_local_hour_angle_degrees=geometry->solar_local_hour_angle_radians*180.0/M_PI; // convert to degrees 
+
+  if(geometry->solar_elevation_angle_radians>0.0)  // the sun is over the horizon 
+  { 
+    Ic=geometry->clear_sky_radiation_W_per_sq_m;  // clear sky radiation
+
     // adjust for cloudiness effects using procedure from Bras' Hydrology text
     if(model->solar_options.cloud_base_height_known==1) 
     {
@@ -359,21 +403,49 @@ void calculate_solar_radiation(pet_model* model)
 
     // all these results are calculated near the land surface, but above the canopy or snow pack.
     model->solar_results.solar_radiation_flux_W_per_sq_m= Ic;   // no clouds. This is on a plane perpendicular to earth-sun line.
-    model->solar_results.solar_radiation_horizontal_flux_W_per_sq_m=Ic*sinalpha; // this is on a horizontal plane
+    model->solar_results.solar_radiation_horizontal_flux_W_per_sq_m=Ic*geometry->sin_solar_elevation_angle; // this is on a horizontal plane
     model->solar_results.solar_radiation_cloudy_flux_W_per_sq_m=Ips; // Considers clouds, on a plane perpendicular to earth-sun line
-    model->solar_results.solar_radiation_horizontal_cloudy_flux_W_per_sq_m=Ips*sinalpha;  // on a horizontal plane tangent to earth
-  
-    // I comment this out because it is more appripriate in a vegetation effect routine  
-    // Ipsg=Kt*Ips;
-
-    // I comment this out because it is part of net radiation calculations done elsewhere
-    // Ieff=Ipsg*(1.0-Albedo);              effective incoming shortwave radiation 
+    model->solar_results.solar_radiation_horizontal_cloudy_flux_W_per_sq_m=Ips*geometry->sin_solar_elevation_angle;  // on a horizontal plane tangent to earth
   }
   
   return;
 }
 
-// Function to calculate hydrological variables needed for evapotranspiration calculation
+//############################################################/
+// Tabulate calculate_solar_geometry() for every day of year  /
+// and hour of the day at this site, so that                  /
+// calculate_solar_radiation() only looks the sun up and      /
+// applies the clouds.  Used when cache_solar_geometry=1 in   /
+// the config.  The table is only used while the site and the /
+// turbidity are the ones it was built for.                   /
+//############################################################/
+void build_solar_geometry_cache(pet_model *model)
+{
+  int doy,hour;
+
+  if(model->solar_cache==NULL)  // rebuilt in place if pet_setup() is run again
+    model->solar_cache=(struct solar_geometry_cache *)pet_model_alloc(model,sizeof(struct solar_geometry_cache));
+  if(model->solar_cache==NULL)
+    return;  // no cache, the geometry is calculated every step
+
+  model->solar_cache->latitude_degrees=model->solar_params.latitude_degrees;
+  model->solar_cache->longitude_degrees=model->solar_params.longitude_degrees;
+  model->solar_cache->site_elevation_m=model->solar_params.site_elevation_m;
+  model->solar_cache->atmospheric_turbidity_factor=model->surf_rad_forcing.atmospheric_turbidity_factor;
+
+  for(doy=1;doy<=366;doy++)
+    for(hour=0;hour<24;hour++)
+      calculate_solar_geometry(model,doy,hour,&model->solar_cache->table[doy-1][hour]);
+}
+
+// Function to calculate hydrological variables needed for evapotranspiration calculation.
+// The saturation vapor pressure and the slope of its curve are not calculated here: run_pet() and run_pet_series()
+// stage both for pet_forcing.air_temperature_C before the method routines run, with one exponential shared with the
+// relative humidity conversion.  Any other caller, e.g. one that sets pet_forcing and calls a pevapotranspiration_*
+// method directly, must first call
+//   calc_air_saturation_vapor_pressure_and_slope_Pa(model->pet_forcing.air_temperature_C,
+//       &model->inter_vars.air_saturation_vapor_pressure_Pa, &model->inter_vars.slope_sat_vap_press_curve_Pa_s);
+// or the values of the previous step are used.
 void calculate_intermediate_variables(pet_model* model)
 {
   // local variables
@@ -404,17 +476,12 @@ void calculate_intermediate_variables(pet_model* model)
                                                                                               // aka 'lambda'
   // all methods other than radiation balance method involve at least some of the aerodynamic method calculations
 
-  // IF HEAT/MOMENTUM ROUGHNESS LENGTHS NOT GIVEN, USE DEFAULTS SO THAT THEIR RATIO IS EQUAL TO 1.
-  if((1.0e-06> model->pet_params.heat_transfer_roughness_length_m) ||
-   (1.0e-06> model->pet_params.momentum_transfer_roughness_length_m))   // zero should be passed down if these are unknown
-  {
-    model->pet_params.heat_transfer_roughness_length_m     =1.0;     // decent default values, and the ratio of these is 1.0
-    model->pet_params.momentum_transfer_roughness_length_m =1.0;
-  }
+  // the heat/momentum roughness lengths, with their defaults if not given, are in model->derived_params
 
   // e_sat is needed for all aerodynamic and Penman-Monteith methods
+  // the caller has already staged it, and the slope of the curve, for pet_forcing.air_temperature_C (see above).
 
-  air_saturation_vapor_pressure_Pa=calc_air_saturation_vapor_pressure_Pa(model->pet_forcing.air_temperature_C);
+  air_saturation_vapor_pressure_Pa=model->inter_vars.air_saturation_vapor_pressure_Pa;
 
   if( (0.0 < model->pet_forcing.relative_humidity_percent) && (100.0 >= model->pet_forcing.relative_humidity_percent))
   {
@@ -432,7 +499,7 @@ void calculate_intermediate_variables(pet_model* model)
     {
       // this is bad.   Actual vapor pressure of air should not be higher than saturated value.
       // warn and reset to something meaningful
-      if (model->bmi.verbose>=1){
+      if (PET_LOG_ON(model, PET_LOG_INFO)){
         fprintf(stderr,"Invalid value of specific humidity with no supplied rel. humidity in PET calc. function:\n");
         fprintf(stderr,"Relative Humidity: %lf percent\n",model->pet_forcing.relative_humidity_percent);
         fprintf(stderr,"Specific Humidity: %lf kg/kg\n",model->pet_forcing.specific_humidity_2m_kg_per_kg);
@@ -450,14 +517,14 @@ void calculate_intermediate_variables(pet_model* model)
                               (model->pet_forcing.air_temperature_C+TK)); // rho_a
 
   // DELTA
-  slope_sat_vap_press_curve_Pa_s=calc_slope_of_air_saturation_vapor_pressure_Pa_per_C(model->pet_forcing.air_temperature_C); 
+  slope_sat_vap_press_curve_Pa_s=model->inter_vars.slope_sat_vap_press_curve_Pa_s;
   delta=slope_sat_vap_press_curve_Pa_s;
 
   // gamma
   water_latent_heat_of_vaporization_J_per_kg=2.501e+06-2370.0*model->pet_forcing.water_temperature_C;  // eqn 2.7.6 Chow etal.
                                                                                               // aka 'lambda'
   psychrometric_constant_Pa_per_C=CP*model->pet_forcing.air_pressure_Pa*
-                                  model->pet_params.heat_transfer_roughness_length_m/
+                                  model->derived_params.heat_transfer_roughness_length_m/
                                   (0.622*water_latent_heat_of_vaporization_J_per_kg);
   gamma=psychrometric_constant_Pa_per_C;
 
@@ -0,0 +1,4 @@
+#!/bin/bash
+gcc ./src/main_run_catchments.c ./src/pet.c ./src/bmi_pet.c ./src/pet_forcing.c ./src/pet_arena.c ./src/pet_batch.c ./src/pet_simd.c ./src/pet_output.c -lm -lpthread -o run_pet_catchments
+mkdir -p ./catchments_output
+./run_pet_catchments ./configs/catchments_manifest.txt ./catchments_output
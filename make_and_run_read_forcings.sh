@@ -1,5 +1,5 @@
 #!/bin/bash
-gcc ./src/main_read_forcing.c ./src/pet.c ./src/bmi_pet.c -lm -o run_bmi_forcings_read
+gcc ./src/main_read_forcing.c ./src/pet.c ./src/bmi_pet.c ./src/pet_forcing.c ./src/pet_arena.c ./src/pet_batch.c ./src/pet_simd.c -lm -o run_bmi_forcings_read
 ./run_bmi_forcings_read ./configs/pet_config_unit_test1.txt 
 ./run_bmi_forcings_read ./configs/pet_config_unit_test2.txt 
 ./run_bmi_forcings_read ./configs/pet_config_unit_test3.txt 
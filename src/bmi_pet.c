@@ -1,12 +1,93 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
 #include "../include/pet.h"
 #include "../include/bmi.h"
 #include "../include/bmi_pet.h"
+#include "../include/pet_forcing.h"
+#include "../include/pet_batch.h"
+#include "../include/pet_arena.h"
+#include "../include/pet_log.h"
+#include "../include/pet_timing.h"
 
 #define INPUT_VAR_NAME_COUNT 7 //
-#define OUTPUT_VAR_NAME_COUNT 1 // water_potential_evaporation_flux; 
+#if defined(PET_TIMING)
+#define OUTPUT_VAR_NAME_COUNT 7 // and the per stage timing of pet_timing.h
+#define TIMING_GRID 1           // the stages of pet_timing.h, PET_TIMING_N_STAGES items
+#else
+#define OUTPUT_VAR_NAME_COUNT 4 // water_potential_evaporation_flux and the daily, monthly, cumulative depths
+#endif
+
+/*
+    Vector grid: with catchment_configs=<file> in the config, one instance runs many catchments.  The file lists one
+    config per line (blank lines and lines starting with # are skipped), each giving the parameters of one catchment
+    as for a single catchment instance; their PET method and forcing file are not used.  The config of the instance
+    itself gives the PET method, the time step and forcing_file=BMI, the forcing of the catchments must come through
+    BMI.  Every variable is then an array with one item per catchment, in the order of the file, and the catchments
+    are run together by pet_batch_run().
+*/
+static int init_vector_catchments_pet(pet_model* pet)
+{
+    FILE* fp;
+    char line[1024], config_file[1024];
+    long n_catchments = 0, i = 0;
+    double *storage = NULL;
+
+    if (pet->bmi.is_forcing_from_bmi != 1) {
+        printf("catchment_configs needs forcing_file=BMI, the forcing of a vector grid is passed in through BMI\n");
+        return BMI_FAILURE;
+    }
+    if ((fp = fopen(pet->catchment_configs, "r")) == NULL) {
+        printf("Can not open catchment_configs file %s\n", pet->catchment_configs);
+        return BMI_FAILURE;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL)
+        if (sscanf(line, "%1023s", config_file) == 1 && config_file[0] != '#')
+            n_catchments++;
+
+    // the batch and its arrays are in the arena, released with the rest of the instance
+    pet->vector_batch = (pet_batch *) pet_model_alloc(pet, sizeof(pet_batch));
+    if (n_catchments > 0)
+        storage = (double *) pet_model_alloc(pet, (size_t)PET_BATCH_ARRAY_COUNT * n_catchments * sizeof(double));
+    if (pet->vector_batch == NULL ||
+        pet_batch_init_storage(pet->vector_batch, storage, n_catchments, pet->pet_method) != 0) {
+        printf("Can not set up %ld catchments of PET method %d from %s\n",
+               n_catchments, pet->pet_method, pet->catchment_configs);
+        pet->vector_batch = NULL;
+        fclose(fp);
+        return BMI_FAILURE;
+    }
+
+    rewind(fp);
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        pet_model* catchment;
+        int status;
+
+        if (sscanf(line, "%1023s", config_file) != 1 || config_file[0] == '#')
+            continue;
+        catchment = new_bmi_pet();
+        catchment->arena_pool = pet->arena_pool;
+        status = read_init_config_pet(catchment, config_file);
+        if (status != BMI_FAILURE) {
+            catchment->pet_method = pet->pet_method;
+            pet_setup(catchment);
+            status = pet_batch_set_catchment(pet->vector_batch, i, catchment) == 0 ? BMI_SUCCESS : BMI_FAILURE;
+        }
+        free_pet_model(catchment);
+        free(catchment);
+        if (status == BMI_FAILURE) {
+            printf("Can not set up catchment %ld from %s\n", i, config_file);
+            fclose(fp);
+            return BMI_FAILURE;
+        }
+        i++;
+    }
+    fclose(fp);
+
+    return BMI_SUCCESS;
+}
 
 static int 
 Initialize (Bmi *self, const char *cfg_file)
@@ -15,14 +96,19 @@ Initialize (Bmi *self, const char *cfg_file)
     pet_model *pet;
     pet = (pet_model *) self->data;
     
+    if (alloc_pet_model(pet) != 0)
+        return BMI_FAILURE;
+
+    // on failure the arena goes again, so a caller that does not Finalize a failed instance leaks nothing
     int config_read_result = read_init_config_pet(pet, cfg_file);
-    if (config_read_result == BMI_FAILURE)
+    if (config_read_result == BMI_FAILURE) {
+        free_pet_model(pet);
         return BMI_FAILURE;
+    }
 
     pet_setup(pet);
 
-    if (pet->bmi.verbose >1)
-        printf("BMI Initialization PET ... setup just finished \n");
+    PET_LOG(pet, PET_LOG_DETAIL, "BMI Initialization PET ... setup just finished \n");
     
     /*
         We might be taking forcing data from the framework via BMI.
@@ -32,89 +118,21 @@ Initialize (Bmi *self, const char *cfg_file)
         That should be determined in pet_setup.
     */
     if (pet->bmi.is_forcing_from_bmi == 1)
-        if (pet->bmi.verbose>1)
-            printf("Using BMI to pass in forcing data, not reading in forcing from file.\n");
+        PET_LOG(pet, PET_LOG_DETAIL, "Using BMI to pass in forcing data, not reading in forcing from file.\n");
     if (pet->bmi.is_forcing_from_bmi == 0){
-        if (pet->bmi.verbose>1)
-            printf("Reading in forcing from file. %s\n", pet->forcing_file);
-
-        // Figure out the number of lines first (also char count)
-        int forcing_line_count, max_forcing_line_length;
-        int count_result = read_file_line_counts_pet(pet->forcing_file, &forcing_line_count, &max_forcing_line_length);
-        if (count_result == -1) {
-            printf("Configured forcing file '%s' could not be opened for reading\n", pet->forcing_file);
-            return BMI_FAILURE;
-        }
-        if (forcing_line_count == 1) {
-            printf("Invalid header-only forcing file '%s'\n", pet->forcing_file);
+        PET_LOG(pet, PET_LOG_DETAIL, "Reading in forcing from file. %s\n", pet->forcing_file);
+
+        if (read_aorc_forcing_file_pet(pet, pet->forcing_file) != 0) {
+            free_pet_model(pet);
             return BMI_FAILURE;
         }
-    
-        // Now initialize empty arrays that depend on number of time steps
-        pet->forcing_data_precip_kg_per_m2 = malloc(sizeof(double) * (pet->bmi.num_timesteps + 1));
-        pet->forcing_data_surface_pressure_Pa = malloc(sizeof(double) * (pet->bmi.num_timesteps + 1));
-        pet->forcing_data_time = malloc(sizeof(long) * (pet->bmi.num_timesteps + 1));
-        pet->forcing_data_incoming_shortwave_W_per_m2 = malloc(sizeof(double) * (pet->bmi.num_timesteps + 1));
-        pet->forcing_data_incoming_longwave_W_per_m2 = malloc(sizeof(double) * (pet->bmi.num_timesteps + 1));
-        pet->forcing_data_specific_humidity_2m_kg_per_kg = malloc(sizeof(double) * (pet->bmi.num_timesteps + 1));
-        pet->forcing_data_air_temperature_2m_K = malloc(sizeof(double) * (pet->bmi.num_timesteps + 1));
-        pet->forcing_data_u_wind_speed_10m_m_per_s = malloc(sizeof(double) * (pet->bmi.num_timesteps + 1));
-        pet->forcing_data_v_wind_speed_10m_m_per_s = malloc(sizeof(double) * (pet->bmi.num_timesteps + 1));
-    
-        // Now open it again to read the forcings
-        FILE* ffp = fopen(pet->forcing_file, "r");
-        // Ensure still exists
-        if (ffp == NULL) {
-            printf("Forcing file '%s' disappeared!", pet->forcing_file);
+    }
+
+    if (pet->catchment_configs != NULL)
+        if (init_vector_catchments_pet(pet) != BMI_SUCCESS) {
+            free_pet_model(pet);
             return BMI_FAILURE;
         }
-    
-        // Read forcing file and parse forcings
-        char line_str[max_forcing_line_length + 1];
-        long year, month, day, hour, minute;
-        double dsec;
-        // First read the header line
-        fgets(line_str, max_forcing_line_length + 1, ffp);
-    
-        if (pet->bmi.verbose > 2) 
-            printf("the number of time steps from the forcing file is: %8.6e \n", pet->bmi.num_timesteps);
-    
-        aorc_forcing_data_pet forcings;
-        for (int i = 0; i < pet->bmi.num_timesteps; i++) {
-            fgets(line_str, max_forcing_line_length + 1, ffp);  // read in a line of AORC data.
-            parse_aorc_line_pet(line_str, &year, &month, &day, &hour, &minute, &dsec, &forcings);
-            pet->forcing_data_precip_kg_per_m2[i] = forcings.precip_kg_per_m2 * ((double)pet->bmi.time_step_size_s);
-            if (pet->bmi.verbose >4)
-                printf("precip %f \n", pet->forcing_data_precip_kg_per_m2[i]);
-            pet->forcing_data_surface_pressure_Pa[i] = forcings.surface_pressure_Pa;
-            if (pet->bmi.verbose >4)
-                printf("surface pressure %f \n", pet->forcing_data_surface_pressure_Pa[i]);
-            pet->forcing_data_incoming_longwave_W_per_m2[i] = forcings.incoming_longwave_W_per_m2;
-            if (pet->bmi.verbose >4)
-                printf("longwave %f \n", pet->forcing_data_incoming_longwave_W_per_m2[i]);
-            pet->forcing_data_incoming_shortwave_W_per_m2[i] = forcings.incoming_shortwave_W_per_m2;
-            if (pet->bmi.verbose >4)
-                printf("shortwave %f \n", pet->forcing_data_incoming_shortwave_W_per_m2[i]);
-            pet->forcing_data_specific_humidity_2m_kg_per_kg[i] = forcings.specific_humidity_2m_kg_per_kg;
-            if (pet->bmi.verbose >4)
-                printf("humidity %f \n", pet->forcing_data_specific_humidity_2m_kg_per_kg[i]);
-            pet->forcing_data_air_temperature_2m_K[i] = forcings.air_temperature_2m_K;
-            if (pet->bmi.verbose >4)
-                printf("air temperature %f \n", pet->forcing_data_air_temperature_2m_K[i]);
-            pet->forcing_data_u_wind_speed_10m_m_per_s[i] = forcings.u_wind_speed_10m_m_per_s;
-            if (pet->bmi.verbose >4)
-                printf("u wind speed %f \n", pet->forcing_data_u_wind_speed_10m_m_per_s[i]);
-            pet->forcing_data_v_wind_speed_10m_m_per_s[i] = forcings.v_wind_speed_10m_m_per_s;
-            if (pet->bmi.verbose >4)
-                printf("v wind speed %f \n", pet->forcing_data_v_wind_speed_10m_m_per_s[i]);
-    
-    
-            pet->forcing_data_time[i] = forcings.time;
-            if (i == 0)
-                pet->bmi.current_time =forcings.time;
-        }
-        fclose(ffp);
-    }
 
     // Set the current time step to the first item in the forcing time series.
     // But should this be an option? Would we ever initialize to a point in the
@@ -129,10 +147,17 @@ Update (Bmi *self)
 {
     pet_model *pet = (pet_model *) self->data;
   
-    if (pet->bmi.verbose >1)
-      printf("BMI Update PET ...\n");
+    PET_LOG(pet, PET_LOG_DETAIL, "BMI Update PET ...\n");
   
-    run_pet(pet);
+    if (pet->vector_batch != NULL) {
+        PET_TIME_STAGE(pet, PET_TIMING_METHOD, pet_batch_run(pet->vector_batch));
+        pet_batch_aggregate(pet->vector_batch, pet->bmi.current_time, (double)pet->bmi.time_step_size_s);
+    }
+    else {
+        if (run_pet(pet) != 0)
+            return BMI_FAILURE;
+        aggregate_pet_step(pet);
+    }
 
     pet->bmi.current_time_step += pet->bmi.time_step_size_s; // Seconds since start of run
     pet->bmi.current_step +=1;                            // time steps since start of run
@@ -329,7 +354,8 @@ pet_model *
 new_bmi_pet()
 {
     pet_model *data;
-    data = (pet_model*) malloc(sizeof(pet_model));
+    // zeroed, several parameters are not read from the config and rely on starting at 0
+    data = (pet_model*) calloc(1, sizeof(pet_model));
 
     return data;
 }
@@ -343,9 +369,20 @@ Finalize (Bmi *self)
   if (pet->bmi.run_unit_tests == 1)
     pet_unit_tests(pet);
 
+#if defined(PET_TIMING)
+  if (pet->timing.calls[PET_TIMING_METHOD] > 0.0)
+    print_pet_timing(pet, (pet->vector_batch != NULL) ? pet->catchment_configs : pet->forcing_file);
+#endif
+
   if (self){
     pet_model* model = (pet_model *)(self->data);
-    self->data = (void*)new_bmi_pet();
+    pet_arena_pool* arena_pool = model->arena_pool;
+
+    // everything the instance allocated goes in one go, then the model is left as new_bmi_pet() gives it, so that
+    // it can be initialized again
+    free_pet_model(model);
+    memset(model, 0, sizeof(pet_model));
+    model->arena_pool = arena_pool;
   }
   return BMI_SUCCESS;
 }
@@ -363,72 +400,18 @@ Get_start_time (Bmi *self, double * time)
 //---------------------------------------------------------------------------------------------------------------------
 static const char *output_var_names[OUTPUT_VAR_NAME_COUNT] = {
   "water_potential_evaporation_flux",
+  "water_potential_evaporation_depth_daily",      // m over the last complete UTC day
+  "water_potential_evaporation_depth_monthly",    // m over the last complete calendar month
+  "water_potential_evaporation_depth_cumulative", // m since Initialize
+#if defined(PET_TIMING)
+  "pet_stage_time_ns",                            // per stage of run_pet since Initialize, on TIMING_GRID
+  "pet_stage_cycle_count",
+  "pet_stage_call_count",
+#endif
 };
 
 //---------------------------------------------------------------------------------------------------------------------
-static const char *output_var_types[OUTPUT_VAR_NAME_COUNT] = {
-  "double",
-};
-
-//---------------------------------------------------------------------------------------------------------------------
-static const int output_var_item_count[OUTPUT_VAR_NAME_COUNT] = {
-  1,
-};
-
-//---------------------------------------------------------------------------------------------------------------------
-static const char *output_var_units[OUTPUT_VAR_NAME_COUNT] = {
-  "m s-1",
-};
-
-//---------------------------------------------------------------------------------------------------------------------
-static const int output_var_grids[OUTPUT_VAR_NAME_COUNT] = {
-        0,
-};
-
-//---------------------------------------------------------------------------------------------------------------------
-static const char *output_var_locations[OUTPUT_VAR_NAME_COUNT] = {
-        "node",
-};
-
-//---------------------------------------------------------------------------------------------------------------------
-static const int input_var_item_count[INPUT_VAR_NAME_COUNT] = {
-  1,
-  1,
-  1,
-  1,
-  1,
-  1,
-  1
-};
-
-//---------------------------------------------------------------------------------------------------------------------
-static const char input_var_grids[INPUT_VAR_NAME_COUNT] = {
-        0,
-        0,
-        0,
-        0,
-        0,
-        0,
-        0
-};
-
-//---------------------------------------------------------------------------------------------------------------------
-static const char *input_var_locations[INPUT_VAR_NAME_COUNT] = {
-        "node",
-        "node",
-        "node",
-        "node",
-        "node",
-        "node",
-        "node"
-};
-
-
-
-
-//---------------------------------------------------------------------------------------------------------------------
-// Don't forget to update Get_value/Get_value_at_indices 
-// (and setter) implementation if these are adjusted
+// Don't forget to update var_descriptors below if these are adjusted
 static const char *input_var_names[INPUT_VAR_NAME_COUNT] = {
     "land_surface_radiation~incoming~longwave__energy_flux",
     "land_surface_air__pressure",
@@ -440,26 +423,95 @@ static const char *input_var_names[INPUT_VAR_NAME_COUNT] = {
 };
 
 //---------------------------------------------------------------------------------------------------------------------
-static const char *input_var_types[INPUT_VAR_NAME_COUNT] = {
-  "double",
-  "double",
-  "double",
-  "double",
-  "double",
-  "double",
-  "double"
+// Everything the BMI functions need to know about an input or output variable, found with one lookup by name.
+// The table MUST stay sorted by name (strcmp order), find_var_descriptor() does a binary search on it.
+typedef struct var_descriptor {
+    const char *name;
+    const char *type;
+    int         itemsize;     // bytes of one item
+    int         item_count;
+    const char *units;
+    int         grid;
+    const char *location;
+    size_t      offset;       // of the value in pet_model
+    size_t      batch_offset; // of the array of values in pet_batch, for a vector grid instance (grid 0 only)
+} var_descriptor;
+
+static const var_descriptor var_descriptors[INPUT_VAR_NAME_COUNT + OUTPUT_VAR_NAME_COUNT] = {
+  {"atmosphere_air_water~vapor__relative_saturation",       "double", sizeof(double), 1, "kg kg-1", 0, "node",
+   offsetof(pet_model, aorc.specific_humidity_2m_kg_per_kg),
+   offsetof(pet_batch, forcing.specific_humidity_2m_kg_per_kg)},
+  {"land_surface_air__pressure",                            "double", sizeof(double), 1, "Pa",      0, "node",
+   offsetof(pet_model, aorc.surface_pressure_Pa),
+   offsetof(pet_batch, forcing.surface_pressure_Pa)},
+  {"land_surface_air__temperature",                         "double", sizeof(double), 1, "K",       0, "node",
+   offsetof(pet_model, aorc.air_temperature_2m_K),
+   offsetof(pet_batch, forcing.air_temperature_2m_K)},
+  {"land_surface_radiation~incoming~longwave__energy_flux",  "double", sizeof(double), 1, "W m-2",   0, "node",
+   offsetof(pet_model, aorc.incoming_longwave_W_per_m2),
+   offsetof(pet_batch, forcing.incoming_longwave_W_per_m2)},
+  {"land_surface_radiation~incoming~shortwave__energy_flux", "double", sizeof(double), 1, "W m-2",   0, "node",
+   offsetof(pet_model, aorc.incoming_shortwave_W_per_m2),
+   offsetof(pet_batch, forcing.incoming_shortwave_W_per_m2)},
+  {"land_surface_wind__x_component_of_velocity",            "double", sizeof(double), 1, "m s-1",   0, "node",
+   offsetof(pet_model, aorc.u_wind_speed_10m_m_per_s),
+   offsetof(pet_batch, forcing.u_wind_speed_10m_m_per_s)},
+  {"land_surface_wind__y_component_of_velocity",            "double", sizeof(double), 1, "m s-1",   0, "node",
+   offsetof(pet_model, aorc.v_wind_speed_10m_m_per_s),
+   offsetof(pet_batch, forcing.v_wind_speed_10m_m_per_s)},
+#if defined(PET_TIMING)
+  {"pet_stage_call_count",                                  "double", sizeof(double), PET_TIMING_N_STAGES, "1",
+   TIMING_GRID, "node", offsetof(pet_model, timing.calls), 0},
+  {"pet_stage_cycle_count",                                 "double", sizeof(double), PET_TIMING_N_STAGES, "1",
+   TIMING_GRID, "node", offsetof(pet_model, timing.cycles), 0},
+  {"pet_stage_time_ns",                                     "double", sizeof(double), PET_TIMING_N_STAGES, "ns",
+   TIMING_GRID, "node", offsetof(pet_model, timing.ns), 0},
+#endif
+  {"water_potential_evaporation_depth_cumulative",          "double", sizeof(double), 1, "m",       0, "node",
+   offsetof(pet_model, aggregates.cumulative_m),
+   offsetof(pet_batch, aggregates.cumulative_m)},
+  {"water_potential_evaporation_depth_daily",               "double", sizeof(double), 1, "m",       0, "node",
+   offsetof(pet_model, aggregates.daily_m),
+   offsetof(pet_batch, aggregates.daily_m)},
+  {"water_potential_evaporation_depth_monthly",             "double", sizeof(double), 1, "m",       0, "node",
+   offsetof(pet_model, aggregates.monthly_m),
+   offsetof(pet_batch, aggregates.monthly_m)},
+  {"water_potential_evaporation_flux",                      "double", sizeof(double), 1, "m s-1",   0, "node",
+   offsetof(pet_model, pet_m_per_s),
+   offsetof(pet_batch, pet_m_per_s)},
 };
 
-//---------------------------------------------------------------------------------------------------------------------
-static const char *input_var_units[INPUT_VAR_NAME_COUNT] = {
-  "W m-2",
-  "Pa",
-  "kg kg-1",
-  "W m-2",
-  "K",
-  "m s-1",
-  "m s-1"
-};
+static int compare_var_descriptor_name(const void *name, const void *descriptor)
+{
+    return strcmp((const char *)name, ((const var_descriptor *)descriptor)->name);
+}
+
+// the descriptor of the variable called name, or NULL if there is no such variable
+static const var_descriptor* find_var_descriptor(const char *name)
+{
+    return (const var_descriptor *)bsearch(name, var_descriptors,
+                                           sizeof(var_descriptors)/sizeof(var_descriptors[0]),
+                                           sizeof(var_descriptor), compare_var_descriptor_name);
+}
+
+// where the values of a variable are: in pet_model for a single catchment, or an array in pet_batch for a vector grid.
+// The timing of TIMING_GRID is always that of the instance.
+static double* var_values(Bmi *self, const var_descriptor *var)
+{
+    pet_model *pet = (pet_model *) self->data;
+    if (pet->vector_batch != NULL && var->grid == 0)
+        return *(double **)((char *)pet->vector_batch + var->batch_offset);
+    return (double *)((char *)pet + var->offset);
+}
+
+// number of items of a variable, one per catchment of a vector grid
+static int var_item_count(Bmi *self, const var_descriptor *var)
+{
+    pet_model *pet = (pet_model *) self->data;
+    if (pet->vector_batch != NULL && var->grid == 0)
+        return (int)pet->vector_batch->n_catchments;
+    return var->item_count;
+}
 
 //---------------------------------------------------------------------------------------------------------------------
 
@@ -513,9 +565,8 @@ static int Get_time_units (Bmi *self, char * units)
 static int Get_current_time (Bmi *self, double * time)
 {
     Get_start_time(self, time);
-    if (((pet_model *) self->data)->bmi.verbose > 2){
-        printf("Current model time step: '%ld'\n", ((pet_model *) self->data)->bmi.current_time_step);
-    }
+    PET_LOG((pet_model *) self->data, PET_LOG_DEBUG, "Current model time step: '%ld'\n",
+            ((pet_model *) self->data)->bmi.current_time_step);
     *time += (((pet_model *) self->data)->bmi.current_step * 
               ((pet_model *) self->data)->bmi.time_step_size_s);
     return BMI_SUCCESS;
@@ -616,45 +667,71 @@ int read_init_config_pet(pet_model* model, const char* config_file)//,
 
         if (strcmp(param_key, "verbose") == 0){
             model->bmi.verbose = strtod(param_value, NULL);
-            if(model->bmi.verbose > 1){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("printing some stuff (level > 1) for unit tests and troubleshooting \n");
             }
-            if(model->bmi.verbose > 2){
+            if(PET_LOG_ON(model, PET_LOG_DEBUG)){
                 printf("printing a lot of stuff (level > 2) for unit tests and troubleshooting \n");
             }
         }
         // jmframe: this should be strtol instead of strtod
         if (strcmp(param_key, "pet_method") == 0){
             model->pet_method = strtod(param_value, NULL);
-            if(model->bmi.verbose > 1){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("set PET method from config file \n");
                 printf("%d\n", model->pet_method);
             }
         }
         if (strcmp(param_key, "yes_aorc") == 0) {
             model->pet_options.yes_aorc = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("set aorc boolean from config file \n");
                 printf("%d\n", model->pet_options.yes_aorc);
             }
             continue;
         }
         if (strcmp(param_key, "forcing_file") == 0) {
-            model->forcing_file = strdup(param_value);
+            model->forcing_file = pet_model_strdup(model, param_value);
             if (strcmp(model->forcing_file,"BMI") == 0){
-                if(model->bmi.verbose >=2)
+                if(PET_LOG_ON(model, PET_LOG_DETAIL))
                     printf("in pet_setup: Getting forcing values from BMI. Not reading in forcing from file. \n");
                 model->bmi.is_forcing_from_bmi = 1;
             }
-            if(model->bmi.verbose >=2){
+            else
+                model->bmi.is_forcing_from_bmi = 0;
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("set forcing file from config file \n");
                 printf("%s\n", model->forcing_file);
             }
             continue;
         }
+        if (strcmp(param_key, "catchment_configs") == 0) {
+            model->catchment_configs = pet_model_strdup(model, param_value);
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
+                printf("set file of catchment configs for a vector grid from config file \n");
+                printf("%s\n", model->catchment_configs);
+            }
+            continue;
+        }
+        if (strcmp(param_key, "forcing_window_steps") == 0) {
+            model->forcing_window_steps = strtol(param_value, NULL, 10);
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
+                printf("set steps of forcing held at a time from config file \n");
+                printf("%ld\n", model->forcing_window_steps);
+            }
+            continue;
+        }
+        if (strcmp(param_key, "forcing_prefetch") == 0) {
+            model->forcing_prefetch = strtol(param_value, NULL, 10);
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
+                printf("set reading of the next forcing window on a helper thread from config file \n");
+                printf("%d\n", model->forcing_prefetch);
+            }
+            continue;
+        }
         if (strcmp(param_key, "wind_speed_measurement_height_m") == 0) {
             model->pet_params.wind_speed_measurement_height_m = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("set wind speed measurement height from config file \n");
                 printf("%lf\n", model->pet_params.wind_speed_measurement_height_m);
             }
@@ -662,7 +739,7 @@ int read_init_config_pet(pet_model* model, const char* config_file)//,
         }
         if (strcmp(param_key, "humidity_measurement_height_m") == 0) {
             model->pet_params.humidity_measurement_height_m = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("set humidity measurement height from config file \n");
                 printf("%lf\n", model->pet_params.humidity_measurement_height_m);
             }
@@ -670,7 +747,7 @@ int read_init_config_pet(pet_model* model, const char* config_file)//,
         }
         if (strcmp(param_key, "vegetation_height_m") == 0) {
             model->pet_params.vegetation_height_m = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("vegetation height from config file \n");
                 printf("%lf\n", model->pet_params.vegetation_height_m);
             }
@@ -678,7 +755,7 @@ int read_init_config_pet(pet_model* model, const char* config_file)//,
         }
         if (strcmp(param_key, "zero_plane_displacement_height_m") == 0) {
             model->pet_params.zero_plane_displacement_height_m = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("zero_plane_displacement height from config file \n");
                 printf("%lf\n", model->pet_params.zero_plane_displacement_height_m);
             }
@@ -686,15 +763,23 @@ int read_init_config_pet(pet_model* model, const char* config_file)//,
         }
         if (strcmp(param_key, "shortwave_radiation_provided") == 0) {
             model->pet_options.shortwave_radiation_provided = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("shortwave radiation provided boolean from config file \n");
                 printf("%d\n", model->pet_options.shortwave_radiation_provided);
             }
             continue;
         }
+        if (strcmp(param_key, "cache_solar_geometry") == 0) {
+            model->solar_options.cache_solar_geometry = strtod(param_value, NULL);
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
+                printf("cache solar geometry boolean from config file \n");
+                printf("%d\n", model->solar_options.cache_solar_geometry);
+            }
+            continue;
+        }
         if (strcmp(param_key, "momentum_transfer_roughness_length_m") == 0) {
             model->pet_params.momentum_transfer_roughness_length_m = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("momentum_transfer_roughness_length_m from config file \n");
                 printf("%lf\n", model->pet_params.momentum_transfer_roughness_length_m);
             }
@@ -702,7 +787,7 @@ int read_init_config_pet(pet_model* model, const char* config_file)//,
         }
         if (strcmp(param_key, "surface_longwave_emissivity") == 0) {
             model->surf_rad_params.surface_longwave_emissivity = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("surface_longwave_emissivity from config file \n");
                 printf("%lf\n", model->surf_rad_params.surface_longwave_emissivity);
             }
@@ -710,7 +795,7 @@ int read_init_config_pet(pet_model* model, const char* config_file)//,
         }
         if (strcmp(param_key, "surface_shortwave_albedo") == 0) {
             model->surf_rad_params.surface_shortwave_albedo = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("surface_shortwave_albedo from config file \n");
                 printf("%lf\n", model->surf_rad_params.surface_shortwave_albedo);
             }
@@ -718,7 +803,7 @@ int read_init_config_pet(pet_model* model, const char* config_file)//,
         }
         if (strcmp(param_key, "surface_shortwave_albedo") == 0) {
             model->surf_rad_params.surface_shortwave_albedo = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("surface_shortwave_albedo from config file \n");
                 printf("%lf\n", model->surf_rad_params.surface_shortwave_albedo);
             }
@@ -726,7 +811,7 @@ int read_init_config_pet(pet_model* model, const char* config_file)//,
         }
         if (strcmp(param_key, "latitude_degrees") == 0) {
             model->solar_params.latitude_degrees = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("latitude_degrees from config file \n");
                 printf("%lf\n", model->solar_params.latitude_degrees);
             }
@@ -734,7 +819,7 @@ int read_init_config_pet(pet_model* model, const char* config_file)//,
         }
         if (strcmp(param_key, "longitude_degrees") == 0) {
             model->solar_params.longitude_degrees = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("longitude_degrees from config file \n");
                 printf("%lf\n", model->solar_params.longitude_degrees);
             }
@@ -742,7 +827,7 @@ int read_init_config_pet(pet_model* model, const char* config_file)//,
         }
         if (strcmp(param_key, "site_elevation_m") == 0) {
             model->solar_params.site_elevation_m = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("site_elevation_m from config file \n");
                 printf("%lf\n", model->solar_params.site_elevation_m);
             }
@@ -750,7 +835,7 @@ int read_init_config_pet(pet_model* model, const char* config_file)//,
         }
         if (strcmp(param_key, "time_step_size_s") == 0) {
             model->bmi.time_step_size_s = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("time_step_size_s from config file \n");
                 printf("%d\n", model->bmi.time_step_size_s);
             }
@@ -758,7 +843,7 @@ int read_init_config_pet(pet_model* model, const char* config_file)//,
         }
         if (strcmp(param_key, "num_timesteps") == 0) {
             model->bmi.num_timesteps = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("num_timesteps from config file \n");
                 printf("%d\n", model->bmi.num_timesteps);
             }
@@ -766,7 +851,7 @@ int read_init_config_pet(pet_model* model, const char* config_file)//,
         }
         if (strcmp(param_key, "run_unit_tests") == 0) {
             model->bmi.run_unit_tests = strtod(param_value, NULL);
-            if(model->bmi.verbose >=2){
+            if(PET_LOG_ON(model, PET_LOG_DETAIL)){
                 printf("Running unit tests \n");
             }
             continue;
@@ -779,57 +864,25 @@ int read_init_config_pet(pet_model* model, const char* config_file)//,
 
 static int Get_var_type (Bmi *self, const char *name, char * type)
 {
-    // Check to see if in output array first
-    for (int i = 0; i < OUTPUT_VAR_NAME_COUNT; i++) {
-        if (strcmp(name, output_var_names[i]) == 0) {
-            strncpy(type, output_var_types[i], BMI_MAX_TYPE_NAME);
-            return BMI_SUCCESS;
-        }
-    }
-    // Then check to see if in input array
-    for (int i = 0; i < INPUT_VAR_NAME_COUNT; i++) {
-        if (strcmp(name, input_var_names[i]) == 0) {
-            strncpy(type, input_var_types[i], BMI_MAX_TYPE_NAME);
-            return BMI_SUCCESS;
-        }
+    const var_descriptor *var = find_var_descriptor(name);
+    if (var == NULL) {
+        // the variable name wasn't recognized
+        type[0] = '\0';
+        return BMI_FAILURE;
     }
-    // If we get here, it means the variable name wasn't recognized
-    type[0] = '\0';
-    return BMI_FAILURE;
+    strncpy(type, var->type, BMI_MAX_TYPE_NAME);
+    return BMI_SUCCESS;
 }
 
 static int Get_var_itemsize (Bmi *self, const char *name, int * size)
 {
-    char type[BMI_MAX_TYPE_NAME];
-    int type_result = Get_var_type(self, name, type);
-    if (type_result != BMI_SUCCESS) {
-        return BMI_FAILURE;
-    }
-
-    if (strcmp (type, "double") == 0) {
-        *size = sizeof(double);
-        return BMI_SUCCESS;
-    }
-    else if (strcmp (type, "float") == 0) {
-        *size = sizeof(float);
-        return BMI_SUCCESS;
-    }
-    else if (strcmp (type, "int") == 0) {
-        *size = sizeof(int);
-        return BMI_SUCCESS;
-    }
-    else if (strcmp (type, "short") == 0) {
-        *size = sizeof(short);
-        return BMI_SUCCESS;
-    }
-    else if (strcmp (type, "long") == 0) {
-        *size = sizeof(long);
-        return BMI_SUCCESS;
-    }
-    else {
+    const var_descriptor *var = find_var_descriptor(name);
+    if (var == NULL) {
         *size = 0;
         return BMI_FAILURE;
     }
+    *size = var->itemsize;
+    return BMI_SUCCESS;
 }
 
 
@@ -839,46 +892,27 @@ static int Get_var_itemsize (Bmi *self, const char *name, int * size)
 //---------------------------------------------------------------------------------------------------------------------
 static int Get_var_location (Bmi *self, const char *name, char * location)
 {
-    // Check to see if in output array first
-    for (int i = 0; i < OUTPUT_VAR_NAME_COUNT; i++) {
-        if (strcmp(name, output_var_names[i]) == 0) {
-            strncpy(location, output_var_locations[i], BMI_MAX_LOCATION_NAME);
-            return BMI_SUCCESS;
-        }
-    }
-    // Then check to see if in input array
-    for (int i = 0; i < INPUT_VAR_NAME_COUNT; i++) {
-        if (strcmp(name, input_var_names[i]) == 0) {
-            strncpy(location, input_var_locations[i], BMI_MAX_LOCATION_NAME);
-            return BMI_SUCCESS;
-        }
+    const var_descriptor *var = find_var_descriptor(name);
+    if (var == NULL) {
+        // the variable name wasn't recognized
+        location[0] = '\0';
+        return BMI_FAILURE;
     }
-    // If we get here, it means the variable name wasn't recognized
-    location[0] = '\0';
-    return BMI_FAILURE;
+    strncpy(location, var->location, BMI_MAX_LOCATION_NAME);
+    return BMI_SUCCESS;
 }
 
 //------------------------------------------------------------------------------
 static int Get_var_grid(Bmi *self, const char *name, int *grid)
 {
-
-    // Check to see if in output array first
-    for (int i = 0; i < OUTPUT_VAR_NAME_COUNT; i++) {
-        if (strcmp(name, output_var_names[i]) == 0) {
-            *grid = output_var_grids[i];
-            return BMI_SUCCESS;
-        }
-    }
-    // Then check to see if in input array
-    for (int i = 0; i < INPUT_VAR_NAME_COUNT; i++) {
-        if (strcmp(name, input_var_names[i]) == 0) {
-            *grid = input_var_grids[i];
-            return BMI_SUCCESS;
-        }
+    const var_descriptor *var = find_var_descriptor(name);
+    if (var == NULL) {
+        // the variable name wasn't recognized
+        grid[0] = '\0';
+        return BMI_FAILURE;
     }
-    // If we get here, it means the variable name wasn't recognized
-    grid[0] = '\0';
-    return BMI_FAILURE;
+    *grid = var->grid;
+    return BMI_SUCCESS;
 }
 
 // ***********************************************************
@@ -886,94 +920,31 @@ static int Get_var_grid(Bmi *self, const char *name, int *grid)
 // ***********************************************************
 static int Get_value_ptr (Bmi *self, const char *name, void **dest)
 {
-    void *src = NULL;
-    /***********************************************************/
-    /***********    OUTPUT   ***********************************/
-    /***********************************************************/
-    if (strcmp (name, "water_potential_evaporation_flux") == 0) {
-        pet_model *pet;
-        pet = (pet_model *) self->data;
-        src = (void*)&pet-> pet_m_per_s;
-        *dest = src;
-        return BMI_SUCCESS;
-    }
-
-    /***********************************************************/
-    /***********    INPUT    ***********************************/
-    /***********************************************************/
-    if (strcmp (name, "land_surface_radiation~incoming~longwave__energy_flux") == 0) {
-        pet_model *pet;
-        pet = (pet_model *) self->data;
-        src = (void*)&pet->aorc.incoming_longwave_W_per_m2;
-        *dest = src;
-        return BMI_SUCCESS;
-    }
-    if (strcmp (name, "land_surface_radiation~incoming~shortwave__energy_flux") == 0) {
-        pet_model *pet;
-        pet = (pet_model *) self->data;
-        src = (void*)&pet->aorc.incoming_shortwave_W_per_m2;
-        *dest = src;
-        return BMI_SUCCESS;
-    }
-    if (strcmp (name, "land_surface_air__pressure") == 0) {
-        pet_model *pet;
-        pet = (pet_model *) self->data;
-        src = (void*)&pet->aorc.surface_pressure_Pa;
-        *dest = src;
-        return BMI_SUCCESS;
-    }
-    if (strcmp (name, "atmosphere_air_water~vapor__relative_saturation") == 0) {
-        pet_model *pet;
-        pet = (pet_model *) self->data;
-        src = (void*)&pet->aorc.specific_humidity_2m_kg_per_kg;
-        *dest = src;
-        return BMI_SUCCESS;
-    }
-    if (strcmp (name, "land_surface_air__temperature") == 0) {
-        pet_model *pet;
-        pet = (pet_model *) self->data;
-        src = (void*)&pet->aorc.air_temperature_2m_K;
-        *dest = src;
-        return BMI_SUCCESS;
-    }
-    if (strcmp (name, "land_surface_wind__x_component_of_velocity") == 0) {
-        pet_model *pet;
-        pet = (pet_model *) self->data;
-        src = (void*)&pet->aorc.u_wind_speed_10m_m_per_s;
-        *dest = src;
-        return BMI_SUCCESS;
-    }
-    if (strcmp (name, "land_surface_wind__y_component_of_velocity") == 0) {
-        pet_model *pet;
-        pet = (pet_model *) self->data;
-        src = (void*)&pet->aorc.v_wind_speed_10m_m_per_s;
-        *dest = src;
-        return BMI_SUCCESS;
-    }
+    const var_descriptor *var = find_var_descriptor(name);
+    if (var == NULL)
+        return BMI_FAILURE;
 
-    return BMI_FAILURE;
+    *dest = var_values(self, var);
+    return BMI_SUCCESS;
 }
 
 //------------------------------------------------------------------------------
 static int Get_value_at_indices (Bmi *self, const char *name, void *dest, int * inds, int len)
 {
-    void *src = NULL;
-    int itemsize = 0;
-
-    if (self->get_value_ptr(self, name, &src) == BMI_FAILURE)
+    const var_descriptor *var = find_var_descriptor(name);
+    if (var == NULL)
         return BMI_FAILURE;
 
-    if (self->get_var_itemsize(self, name, &itemsize) == BMI_FAILURE)
-        return BMI_FAILURE;
-
-    { /* Copy the data */
-        size_t i;
-        size_t offset;
-        char * ptr;
-        for (i=0, ptr=(char*)dest; i<len; i++, ptr+=itemsize) {
-            offset = inds[i] * itemsize;
-            memcpy (ptr, (char*)src + offset, itemsize);
-        }
+    { /* Gather the data, every variable is a double */
+        const double *src = var_values(self, var);
+        double *to = (double *)dest;
+        int count = var_item_count(self, var);
+        int i;
+        for (i = 0; i < len; i++)
+            if (inds[i] < 0 || inds[i] >= count)
+                return BMI_FAILURE;
+        for (i = 0; i < len; i++)
+            to[i] = src[inds[i]];
     }
 
     return BMI_SUCCESS;
@@ -982,32 +953,22 @@ static int Get_value_at_indices (Bmi *self, const char *name, void *dest, int *
 //------------------------------------------------------------------------------
 static int Get_value(Bmi * self, const char * name, void *dest)
 {
-    void *src = NULL;
-    int nbytes = 0;
-
-    if (self->get_value_ptr (self, name, &src) == BMI_FAILURE)
+    const var_descriptor *var = find_var_descriptor(name);
+    if (var == NULL)
         return BMI_FAILURE;
 
-    if (self->get_var_nbytes (self, name, &nbytes) == BMI_FAILURE)
-        return BMI_FAILURE;
-    
-    memcpy(dest, src, nbytes);
+    memcpy(dest, var_values(self, var), var->itemsize * var_item_count(self, var));
 
     return BMI_SUCCESS;
 }
 
 static int Set_value (Bmi *self, const char *name, void *array)
 {
-    void * dest = NULL;
-    int nbytes = 0;
-
-    if (self->get_value_ptr(self, name, &dest) == BMI_FAILURE)
+    const var_descriptor *var = find_var_descriptor(name);
+    if (var == NULL)
         return BMI_FAILURE;
 
-    if (self->get_var_nbytes(self, name, &nbytes) == BMI_FAILURE)
-        return BMI_FAILURE;
-
-    memcpy (dest, array, nbytes);
+    memcpy (var_values(self, var), array, var->itemsize * var_item_count(self, var));
 
     return BMI_SUCCESS;
 }
@@ -1016,24 +977,71 @@ static int Set_value (Bmi *self, const char *name, void *array)
 //------------------------------------------------------------------------------
 static int Set_value_at_indices (Bmi *self, const char *name, int * inds, int len, void *src)
 {
-    void * to = NULL;
-    int itemsize = 0;
+    const var_descriptor *var = find_var_descriptor(name);
+    if (var == NULL)
+        return BMI_FAILURE;
 
-    if (self->get_value_ptr (self, name, &to) == BMI_FAILURE)
+    { /* Scatter the data, every variable is a double */
+        double *to = var_values(self, var);
+        const double *from = (const double *)src;
+        int count = var_item_count(self, var);
+        int i;
+        for (i = 0; i < len; i++)
+            if (inds[i] < 0 || inds[i] >= count)
+                return BMI_FAILURE;
+        for (i = 0; i < len; i++)
+            to[inds[i]] = from[i];
+    }
+    return BMI_SUCCESS;
+}
+
+// ***********************************************************
+// ** EXTENSION: GET & SET BY VARIABLE HANDLE, BULK FORCING **
+// ***********************************************************
+// A handle is the index of the variable in var_descriptors, so it is the same for every instance.
+int pet_resolve_var(Bmi *self, const char *name)
+{
+    const var_descriptor *var = find_var_descriptor(name);
+    if (var == NULL)
+        return -1;
+    return (int)(var - var_descriptors);
+}
+
+int pet_get_by_handle(Bmi *self, int handle, void *dest)
+{
+    const var_descriptor *var;
+    if (handle < 0 || handle >= INPUT_VAR_NAME_COUNT + OUTPUT_VAR_NAME_COUNT)
         return BMI_FAILURE;
 
-    if (self->get_var_itemsize(self, name, &itemsize) == BMI_FAILURE)
+    var = &var_descriptors[handle];
+    memcpy(dest, var_values(self, var), var->itemsize * var_item_count(self, var));
+    return BMI_SUCCESS;
+}
+
+int pet_set_by_handle(Bmi *self, int handle, const void *src)
+{
+    const var_descriptor *var;
+    if (handle < 0 || handle >= INPUT_VAR_NAME_COUNT + OUTPUT_VAR_NAME_COUNT)
         return BMI_FAILURE;
 
-    { /* Copy the data */
-        size_t i;
-        size_t offset;
-        char * ptr;
-        for (i=0, ptr=(char*)src; i<len; i++, ptr+=itemsize) {
-            offset = inds[i] * itemsize;
-            memcpy ((char*)to + offset, ptr, itemsize);
-        }
-    }
+    var = &var_descriptors[handle];
+    memcpy(var_values(self, var), src, var->itemsize * var_item_count(self, var));
+    return BMI_SUCCESS;
+}
+
+int pet_set_forcing(Bmi *self, const pet_forcing_inputs *forcing)
+{
+    pet_model *pet = (pet_model *) self->data;
+    if (pet->vector_batch != NULL)
+        return BMI_FAILURE;  // one catchment only, a vector grid takes whole arrays through set_value
+
+    pet->aorc.incoming_longwave_W_per_m2     = forcing->incoming_longwave_W_per_m2;
+    pet->aorc.incoming_shortwave_W_per_m2    = forcing->incoming_shortwave_W_per_m2;
+    pet->aorc.surface_pressure_Pa            = forcing->surface_pressure_Pa;
+    pet->aorc.specific_humidity_2m_kg_per_kg = forcing->specific_humidity_2m_kg_per_kg;
+    pet->aorc.air_temperature_2m_K           = forcing->air_temperature_2m_K;
+    pet->aorc.u_wind_speed_10m_m_per_s       = forcing->u_wind_speed_10m_m_per_s;
+    pet->aorc.v_wind_speed_10m_m_per_s       = forcing->v_wind_speed_10m_m_per_s;
     return BMI_SUCCESS;
 }
 
@@ -1081,52 +1089,24 @@ static int Get_output_var_names (Bmi *self, char ** names)
 //----------------------------------------------------------------------
 static int Get_var_units (Bmi *self, const char *name, char * units)
 {
-    // Check to see if in output array first
-    for (int i = 0; i < OUTPUT_VAR_NAME_COUNT; i++) {
-        if (strcmp(name, output_var_names[i]) == 0) {
-            strncpy(units, output_var_units[i], BMI_MAX_UNITS_NAME);
-            return BMI_SUCCESS;
-        }
-    }
-    // Then check to see if in input array
-    for (int i = 0; i < INPUT_VAR_NAME_COUNT; i++) {
-        if (strcmp(name, input_var_names[i]) == 0) {
-            strncpy(units, input_var_units[i], BMI_MAX_UNITS_NAME);
-            return BMI_SUCCESS;
-        }
+    const var_descriptor *var = find_var_descriptor(name);
+    if (var == NULL) {
+        // the variable name wasn't recognized
+        units[0] = '\0';
+        return BMI_FAILURE;
     }
-    // If we get here, it means the variable name wasn't recognized
-    units[0] = '\0';
-    return BMI_FAILURE;
+    strncpy(units, var->units, BMI_MAX_UNITS_NAME);
+    return BMI_SUCCESS;
 }
 
 //----------------------------------------------------------------------
 static int Get_var_nbytes (Bmi *self, const char *name, int * nbytes)
 {
-    int item_size;
-    int item_size_result = Get_var_itemsize(self, name, &item_size);
-    if (item_size_result != BMI_SUCCESS) {
+    const var_descriptor *var = find_var_descriptor(name);
+    if (var == NULL)
         return BMI_FAILURE;
-    }
-    int item_count = -1;
-    for (int i = 0; i < INPUT_VAR_NAME_COUNT; i++) {
-        if (strcmp(name, input_var_names[i]) == 0) {
-            item_count = input_var_item_count[i];
-            break;
-        }
-    }
-    if (item_count < 1) {
-        for (int i = 0; i < OUTPUT_VAR_NAME_COUNT; i++) {
-            if (strcmp(name, output_var_names[i]) == 0) {
-                item_count = output_var_item_count[i];
-                break;
-            }
-        }
-    }
-    if (item_count < 1)
-        item_count = ((pet_model *) self->data)->bmi.num_timesteps;
 
-    *nbytes = item_size * item_count;
+    *nbytes = var->itemsize * var_item_count(self, var);
     return BMI_SUCCESS;
 }
 
@@ -1141,6 +1121,12 @@ static int Get_grid_rank (Bmi *self, int grid, int * rank)
         *rank = 1;
         return BMI_SUCCESS;
     }
+#if defined(PET_TIMING)
+    else if (grid == TIMING_GRID) {
+        *rank = 1;
+        return BMI_SUCCESS;
+    }
+#endif
     else {
         *rank = -1;
         return BMI_FAILURE;
@@ -1150,10 +1136,17 @@ static int Get_grid_rank (Bmi *self, int grid, int * rank)
 //----------------------------------------------------------------------
 static int Get_grid_size(Bmi *self, int grid, int * size)
 {
+    pet_model *pet = (pet_model *) self->data;
     if (grid == 0) {
-        *size = 1;
+        *size = (pet->vector_batch != NULL) ? (int)pet->vector_batch->n_catchments : 1;
+        return BMI_SUCCESS;
+    }
+#if defined(PET_TIMING)
+    else if (grid == TIMING_GRID) {
+        *size = PET_TIMING_N_STAGES;
         return BMI_SUCCESS;
     }
+#endif
     else {
         *size = -1;
         return BMI_FAILURE;
@@ -1164,11 +1157,18 @@ static int Get_grid_size(Bmi *self, int grid, int * size)
 static int Get_grid_type (Bmi *self, int grid, char * type)
 {
     int status = BMI_FAILURE;
+    pet_model *pet = (pet_model *) self->data;
 
     if (grid == 0) {
-        strncpy(type, "scalar", BMI_MAX_TYPE_NAME);
+        strncpy(type, (pet->vector_batch != NULL) ? "vector" : "scalar", BMI_MAX_TYPE_NAME);
+        status = BMI_SUCCESS;
+    }
+#if defined(PET_TIMING)
+    else if (grid == TIMING_GRID) {
+        strncpy(type, "vector", BMI_MAX_TYPE_NAME);
         status = BMI_SUCCESS;
     }
+#endif
     else {
         type[0] = '\0';
         status = BMI_FAILURE;
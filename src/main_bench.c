@@ -0,0 +1,341 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/bmi.h"
+#include "../include/pet.h"
+#include "../include/bmi_pet.h"
+#include "../include/pet_forcing.h"
+
+/*
+    Microbenchmarks of the PET hot path, for telling whether a change helps or hurts.
+    Run from the top of the repository, it uses ./configs/pet_config_cat_67.txt and the bundled forcing/cat-*.csv.
+
+    Each benchmark is repeated, doubling the repetitions, until it has run for at least BENCH_MIN_SECONDS, and one
+    csv line is printed per benchmark:
+        benchmark,unit,value,iterations
+    where unit is ns_per_step, ns_per_call, ns_per_round_trip or rows_per_s.  Lines starting with # are comments.
+
+    usage: pet_bench [config, default ./configs/pet_config_cat_67.txt]
+*/
+
+#define BENCH_MIN_SECONDS 0.25
+
+// defined in pet_tools.h and PEt*Method.h, which are compiled into pet.c only
+double pevapotranspiration_energy_balance_method(pet_model *model);
+double pevapotranspiration_aerodynamic_method(pet_model *model);
+double pevapotranspiration_combination_method(pet_model *model);
+double pevapotranspiration_priestley_taylor_method(pet_model *model);
+double pevapotranspiration_penman_monteith_method(pet_model *model);
+double calculate_net_radiation_W_per_sq_m(pet_model *model);
+void calculate_solar_radiation(pet_model *model);
+void build_solar_geometry_cache(pet_model *model);
+
+static const char *forcing_files[] = {
+  "./forcing/cat-27_2015.csv",
+  "./forcing/cat-52_2015.csv",
+  "./forcing/cat-67_2015.csv"
+};
+#define N_FORCING_FILES (sizeof(forcing_files)/sizeof(forcing_files[0]))
+
+static const struct {
+  int         pet_method;
+  const char* name;
+  double    (*method)(pet_model *model);
+} methods[] = {
+  {1, "pevapotranspiration_energy_balance_method",    pevapotranspiration_energy_balance_method},
+  {2, "pevapotranspiration_aerodynamic_method",       pevapotranspiration_aerodynamic_method},
+  {3, "pevapotranspiration_combination_method",       pevapotranspiration_combination_method},
+  {4, "pevapotranspiration_priestley_taylor_method",  pevapotranspiration_priestley_taylor_method},
+  {5, "pevapotranspiration_penman_monteith_method",   pevapotranspiration_penman_monteith_method}
+};
+#define N_METHODS (sizeof(methods)/sizeof(methods[0]))
+
+// state shared by the benchmarks
+typedef struct bench_state {
+  Bmi*        bmi;                 // instance initialized from the config
+  pet_model*  model;               // bmi->data
+  double      start_time;          // bmi.current_time after Initialize
+  pet_model*  snapshots;           // copies of the model with the forcing of every step staged by run_pet
+  long        n_snapshots;
+  double    (*method)(pet_model *model);
+  char**      lines;               // data lines of the forcing files, for parse_aorc_line_pet
+  long        n_lines;
+  long        n_file_rows;         // data rows of all the forcing files
+  double      sink;                // results are summed here so the compiler can not drop the calls
+} bench_state;
+
+static double now_seconds(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+}
+
+/**************************************************************************************************
+    Run benchmark(state, repetitions) with doubling repetitions until it takes BENCH_MIN_SECONDS.
+    items_per_repetition is the number of steps, calls or rows one repetition does.  Prints the csv line.
+**************************************************************************************************/
+static void run_benchmark(const char* name, const char* unit, void (*benchmark)(bench_state*, long),
+                          bench_state* state, long items_per_repetition)
+{
+  long repetitions = 1;
+  double elapsed, value;
+
+  for(;;) {
+    double start = now_seconds();
+    benchmark(state, repetitions);
+    elapsed = now_seconds() - start;
+    if(elapsed >= BENCH_MIN_SECONDS || repetitions >= (1L << 40))
+      break;
+    repetitions *= 2;
+  }
+
+  if(strcmp(unit, "rows_per_s") == 0)
+    value = repetitions * items_per_repetition / elapsed;
+  else
+    value = 1.0e9 * elapsed / (repetitions * items_per_repetition);
+  printf("%s,%s,%.3f,%ld\n", name, unit, value, repetitions * items_per_repetition);
+  fflush(stdout);
+}
+
+/**************************************************************************************************
+    The benchmarks
+**************************************************************************************************/
+static void bench_run_pet_series(bench_state* state, long repetitions)
+{
+  pet_model* model = state->model;
+  long n_steps = model->bmi.num_timesteps;
+  double* pet_m_per_s = (double *) malloc(n_steps * sizeof(double));
+  long r;
+
+  for(r = 0; r < repetitions; r++) {
+    model->bmi.current_step = 0;
+    model->bmi.current_time_step = 0;
+    model->bmi.current_time = state->start_time;
+    run_pet_series(model, n_steps, pet_m_per_s);
+    state->sink += pet_m_per_s[n_steps-1];
+  }
+  free(pet_m_per_s);
+}
+
+static void bench_method(bench_state* state, long repetitions)
+{
+  long r, i;
+  for(r = 0; r < repetitions; r++)
+    for(i = 0; i < state->n_snapshots; i++)
+      state->sink += state->method(&state->snapshots[i]);
+}
+
+static void bench_solar_radiation(bench_state* state, long repetitions)
+{
+  long r, i;
+  for(r = 0; r < repetitions; r++)
+    for(i = 0; i < state->n_snapshots; i++) {
+      calculate_solar_radiation(&state->snapshots[i]);
+      state->sink += state->snapshots[i].solar_results.solar_radiation_flux_W_per_sq_m;
+    }
+}
+
+static void bench_net_radiation(bench_state* state, long repetitions)
+{
+  long r, i;
+  for(r = 0; r < repetitions; r++)
+    for(i = 0; i < state->n_snapshots; i++)
+      state->sink += calculate_net_radiation_W_per_sq_m(&state->snapshots[i]);
+}
+
+static void bench_parse_aorc_line(bench_state* state, long repetitions)
+{
+  struct aorc_forcing_data_pet aorc;
+  long year, month, day, hour, minute;
+  double second;
+  long r, i;
+
+  for(r = 0; r < repetitions; r++)
+    for(i = 0; i < state->n_lines; i++) {
+      parse_aorc_line_pet(state->lines[i], &year, &month, &day, &hour, &minute, &second, &aorc);
+      state->sink += aorc.air_temperature_2m_K;
+    }
+}
+
+static void bench_read_forcing_file(bench_state* state, long repetitions)
+{
+  pet_model* model = (pet_model *) calloc(1, sizeof(pet_model));
+  unsigned int f;
+  long r;
+
+  model->bmi.time_step_size_s = state->model->bmi.time_step_size_s;
+  for(r = 0; r < repetitions; r++)
+    for(f = 0; f < N_FORCING_FILES; f++) {
+      model->bmi.num_timesteps = 0;   // every row of the file
+      if(read_aorc_forcing_file_pet(model, forcing_files[f]) != 0)
+        exit(1);
+      state->sink += model->forcing_data_air_temperature_2m_K[0];
+      free_pet_model(model);
+    }
+  free(model);
+}
+
+static void bench_bmi_round_trip(bench_state* state, long repetitions)
+{
+  Bmi* bmi = state->bmi;
+  double temperature = 290.0, pet_m_per_s;
+  long r;
+
+  for(r = 0; r < repetitions; r++) {
+    bmi->set_value(bmi, "land_surface_air__temperature", &temperature);
+    bmi->get_value(bmi, "water_potential_evaporation_flux", &pet_m_per_s);
+    state->sink += pet_m_per_s;
+  }
+}
+
+static void bench_handle_round_trip(bench_state* state, long repetitions)
+{
+  Bmi* bmi = state->bmi;
+  int temperature_handle = pet_resolve_var(bmi, "land_surface_air__temperature");
+  int pet_handle = pet_resolve_var(bmi, "water_potential_evaporation_flux");
+  double temperature = 290.0, pet_m_per_s;
+  long r;
+
+  for(r = 0; r < repetitions; r++) {
+    pet_set_by_handle(bmi, temperature_handle, &temperature);
+    pet_get_by_handle(bmi, pet_handle, &pet_m_per_s);
+    state->sink += pet_m_per_s;
+  }
+}
+
+static void bench_set_forcing(bench_state* state, long repetitions)
+{
+  Bmi* bmi = state->bmi;
+  pet_forcing_inputs forcing = {300.0, 500.0, 98000.0, 0.01, 290.0, 2.0, 1.0};
+  long r;
+
+  for(r = 0; r < repetitions; r++) {
+    forcing.air_temperature_2m_K += 1.0e-9;
+    pet_set_forcing(bmi, &forcing);
+    state->sink += state->model->aorc.air_temperature_2m_K;
+  }
+}
+
+/**************************************************************************************************
+    Setup
+**************************************************************************************************/
+// copy the model once the forcing of every step has been staged and the PET calculated by run_pet
+static void take_snapshots(bench_state* state)
+{
+  pet_model* model = state->model;
+  double pet_m_per_s;
+  long i;
+
+  model->bmi.current_step = 0;
+  model->bmi.current_time_step = 0;
+  model->bmi.current_time = state->start_time;
+  for(i = 0; i < state->n_snapshots; i++) {
+    run_pet_series(model, 1, &pet_m_per_s);
+    state->snapshots[i] = *model;
+  }
+}
+
+// read the data lines of the forcing files into memory
+static void read_forcing_lines(bench_state* state)
+{
+  char line[1024];
+  long n_allocated = 4096;
+  unsigned int f;
+
+  state->lines = (char **) malloc(n_allocated * sizeof(char *));
+  state->n_lines = 0;
+  for(f = 0; f < N_FORCING_FILES; f++) {
+    FILE* fp = fopen(forcing_files[f], "r");
+    if(fp == NULL) {
+      printf("Can not open forcing file %s, run pet_bench from the top of the repository\n", forcing_files[f]);
+      exit(1);
+    }
+    if(fgets(line, sizeof(line), fp) == NULL) {   // header
+      fclose(fp);
+      continue;
+    }
+    while(fgets(line, sizeof(line), fp) != NULL) {
+      if(state->n_lines == n_allocated) {
+        n_allocated *= 2;
+        state->lines = (char **) realloc(state->lines, n_allocated * sizeof(char *));
+      }
+      state->lines[state->n_lines++] = strdup(line);
+    }
+    fclose(fp);
+  }
+  state->n_file_rows = state->n_lines;
+}
+
+int
+main(int argc, const char *argv[])
+{
+  const char* config_file = (argc > 1) ? argv[1] : "./configs/pet_config_cat_67.txt";
+  bench_state state;
+  char name[128];
+  unsigned int m;
+  long i;
+
+  memset(&state, 0, sizeof(state));
+  state.bmi = (Bmi *) malloc(sizeof(Bmi));
+  register_bmi_pet(state.bmi);
+  if(state.bmi->initialize(state.bmi, config_file) != BMI_SUCCESS || state.bmi->data == NULL) {
+    printf("Could not initialize PET from %s\n", config_file);
+    exit(1);
+  }
+  state.model = (pet_model *) state.bmi->data;
+  if(state.model->bmi.is_forcing_from_bmi == 1) {
+    printf("%s must read its forcing from a file\n", config_file);
+    exit(1);
+  }
+  state.model->bmi.verbose = 0;
+  state.model->bmi.run_unit_tests = 0;
+  state.start_time = state.model->bmi.current_time;
+  state.n_snapshots = state.model->bmi.num_timesteps;
+  state.snapshots = (pet_model *) malloc(state.n_snapshots * sizeof(pet_model));
+  read_forcing_lines(&state);
+
+  printf("# pet_bench, %s, %ld steps, %ld forcing rows\n", config_file, state.n_snapshots, state.n_file_rows);
+  printf("benchmark,unit,value,iterations\n");
+
+  for(m = 0; m < N_METHODS; m++) {
+    state.model->pet_method = methods[m].pet_method;
+    pet_setup(state.model);
+
+    snprintf(name, sizeof(name), "run_pet_series_method_%d", methods[m].pet_method);
+    run_benchmark(name, "ns_per_step", bench_run_pet_series, &state, state.model->bmi.num_timesteps);
+
+    take_snapshots(&state);
+    state.method = methods[m].method;
+    run_benchmark(methods[m].name, "ns_per_call", bench_method, &state, state.n_snapshots);
+  }
+
+  // radiation, on the steps staged for the last method
+  run_benchmark("calculate_net_radiation_W_per_sq_m", "ns_per_call", bench_net_radiation, &state, state.n_snapshots);
+  run_benchmark("calculate_solar_radiation", "ns_per_call", bench_solar_radiation, &state, state.n_snapshots);
+  build_solar_geometry_cache(state.model);
+  for(i = 0; i < state.n_snapshots; i++)
+    state.snapshots[i].solar_cache = state.model->solar_cache;
+  run_benchmark("calculate_solar_radiation_cached", "ns_per_call", bench_solar_radiation, &state, state.n_snapshots);
+
+  // forcing ingest
+  run_benchmark("parse_aorc_line_pet", "rows_per_s", bench_parse_aorc_line, &state, state.n_lines);
+  run_benchmark("read_aorc_forcing_file_pet", "rows_per_s", bench_read_forcing_file, &state, state.n_file_rows);
+
+  // BMI
+  run_benchmark("bmi_set_value_get_value", "ns_per_round_trip", bench_bmi_round_trip, &state, 1);
+  run_benchmark("pet_set_by_handle_get_by_handle", "ns_per_round_trip", bench_handle_round_trip, &state, 1);
+  run_benchmark("pet_set_forcing", "ns_per_call", bench_set_forcing, &state, 1);
+
+  printf("# sink %g\n", state.sink);
+
+  for(i = 0; i < state.n_lines; i++)
+    free(state.lines[i]);
+  free(state.lines);
+  free(state.snapshots);
+  state.bmi->finalize(state.bmi);
+  free(state.bmi->data);
+  free(state.bmi);
+  return 0;
+}
@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../include/pet.h"
+#include "../include/pet_forcing.h"
+
+/*
+    Converts an AORC forcing csv (e.g. forcing/cat-67_2015.csv) into the binary columnar forcing format described in
+    include/pet_forcing.h.  The binary file can be given as forcing_file in a config in place of the csv.
+    usage: pet_convert_forcing <forcing csv> <binary output> [time_step_size_s, default 3600]
+*/
+int
+main(int argc, const char *argv[])
+{
+  pet_model *model;
+
+  if (argc < 3) {
+    printf("usage: %s <forcing csv> <binary output> [time_step_size_s, default 3600]\n", argv[0]);
+    exit(1);
+  }
+
+  model = (pet_model *) calloc(1, sizeof(pet_model));
+  model->bmi.time_step_size_s = (argc > 3) ? atoi(argv[3]) : 3600;
+  model->bmi.num_timesteps = 0;  // take every row of the csv
+
+  if (read_aorc_forcing_file_pet(model, argv[1]) != 0)
+    return 1;
+  if (write_forcing_binary_pet(model, argv[2]) != 0)
+    return 1;
+
+  printf("wrote %ld rows of %s to %s\n", model->bmi.num_timesteps, argv[1], argv[2]);
+
+  free_pet_model(model);
+  free(model);
+  return 0;
+}
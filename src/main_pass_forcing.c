@@ -10,47 +10,29 @@
 
 /***************************************************************
     Function to pass the forcing data from AORC to PET using BMI.
-    This requires a lot of getters and setters, 
-    so no need to clutter up main program
+    All seven forcings are set in PET with one call.
 ***************************************************************/
 void pass_forcing_from_aorc_to_pet(Bmi *pet_bmi_model, Bmi *aorc_bmi_model){
 
-    /********************************************************************
-        TODO: Get variable names through BMI, then loop through those
-              so we don't re-write the get/set functions over and over
-    ********************************************************************/
-
-    double *var = NULL;
-    var = (double*) malloc (sizeof (double)*1);
+    pet_forcing_inputs forcing;
 
 //    printf("getting AORC from BMI and setting in PET\n");
-    const char* var_name1 = "land_surface_air__temperature";
-    aorc_bmi_model->get_value(aorc_bmi_model, var_name1, &(var[0]));
-    pet_bmi_model->set_value(pet_bmi_model, var_name1, &(var[0]));
-
-    const char* var_name2 = "land_surface_air__pressure";
-    aorc_bmi_model->get_value(aorc_bmi_model, var_name2, &(var[0]));
-    pet_bmi_model->set_value(pet_bmi_model, var_name2, &(var[0]));
-
-    const char* var_name3 = "atmosphere_air_water~vapor__relative_saturation";
-    aorc_bmi_model->get_value(aorc_bmi_model, var_name3, &(var[0]));
-    pet_bmi_model->set_value(pet_bmi_model, var_name3, &(var[0]));
-
-    const char* var_name5 = "land_surface_radiation~incoming~shortwave__energy_flux";
-    aorc_bmi_model->get_value(aorc_bmi_model, var_name5, &(var[0]));
-    pet_bmi_model->set_value(pet_bmi_model, var_name5, &(var[0]));
-
-    const char* var_name6 = "land_surface_radiation~incoming~longwave__energy_flux";
-    aorc_bmi_model->get_value(aorc_bmi_model, var_name6, &(var[0]));
-    pet_bmi_model->set_value(pet_bmi_model, var_name6, &(var[0]));
-
-    const char* var_name7 = "land_surface_wind__x_component_of_velocity";
-    aorc_bmi_model->get_value(aorc_bmi_model, var_name7, &(var[0]));
-    pet_bmi_model->set_value(pet_bmi_model, var_name7, &(var[0]));
-
-    const char* var_name8 = "land_surface_wind__y_component_of_velocity";
-    aorc_bmi_model->get_value(aorc_bmi_model, var_name8, &(var[0]));
-    pet_bmi_model->set_value(pet_bmi_model, var_name8, &(var[0]));
+    aorc_bmi_model->get_value(aorc_bmi_model, "land_surface_radiation~incoming~longwave__energy_flux",
+                              &forcing.incoming_longwave_W_per_m2);
+    aorc_bmi_model->get_value(aorc_bmi_model, "land_surface_radiation~incoming~shortwave__energy_flux",
+                              &forcing.incoming_shortwave_W_per_m2);
+    aorc_bmi_model->get_value(aorc_bmi_model, "land_surface_air__pressure",
+                              &forcing.surface_pressure_Pa);
+    aorc_bmi_model->get_value(aorc_bmi_model, "atmosphere_air_water~vapor__relative_saturation",
+                              &forcing.specific_humidity_2m_kg_per_kg);
+    aorc_bmi_model->get_value(aorc_bmi_model, "land_surface_air__temperature",
+                              &forcing.air_temperature_2m_K);
+    aorc_bmi_model->get_value(aorc_bmi_model, "land_surface_wind__x_component_of_velocity",
+                              &forcing.u_wind_speed_10m_m_per_s);
+    aorc_bmi_model->get_value(aorc_bmi_model, "land_surface_wind__y_component_of_velocity",
+                              &forcing.v_wind_speed_10m_m_per_s);
+
+    pet_set_forcing(pet_bmi_model, &forcing);
 }
 
 /************************************************************************
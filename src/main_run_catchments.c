@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "../include/bmi.h"
+#include "../include/pet.h"
+#include "../include/bmi_pet.h"
+#include "../include/pet_forcing.h"
+#include "../include/pet_arena.h"
+#include "../include/pet_output.h"
+
+/*
+    Runs many PET instances (catchments) in one process on a pool of threads.  Each catchment is initialized from its
+    own config, run over its whole forcing file with run_pet_series and finalized by whichever thread picks it up, so
+    instances never share a thread at the same time.  Each thread recycles the memory of the catchments it has
+    finished through its own pet_arena_pool.  The time and PET of every step of each catchment are written with a
+    buffered pet_output (pet_output.h) to <output dir>/<catchment id>.csv, or to <catchment id>.bin as raw
+    little-endian doubles (time, PET, time, PET, ...) if the output format is binary.
+
+    The manifest has one catchment per line, blank lines and lines starting with # are skipped:
+        <catchment id> <config file> [forcing file]
+    If the forcing file is given it is read in place of the forcing_file of the config, so one config can be shared by
+    catchments that differ only in their forcing.  See configs/catchments_manifest.txt.
+
+    usage: pet_run_catchments <manifest> <output dir> [number of threads, default all cores] [csv|binary]
+*/
+
+#define MANIFEST_FIELD_LENGTH 1024
+
+typedef struct catchment {
+  char id[MANIFEST_FIELD_LENGTH];
+  char config_file[MANIFEST_FIELD_LENGTH];
+  char forcing_file[MANIFEST_FIELD_LENGTH];   // empty to use the forcing_file of the config
+  long n_steps;                               // steps run
+  int  status;                                // 0 on success, -1 on failure
+} catchment;
+
+typedef struct catchment_pool {
+  catchment*      catchments;
+  long            n_catchments;
+  long            next_catchment;   // next catchment to be picked up by a thread, guarded by lock
+  const char*     output_dir;
+  int             output_format;    // pet_output_format
+  pthread_mutex_t lock;
+} catchment_pool;
+
+/**************************************************************************************************
+    Read the manifest into an array of catchments.  Returns the number of catchments, or -1.
+**************************************************************************************************/
+static long read_manifest(const char* manifest_file, catchment** catchments)
+{
+  FILE* fp;
+  char line[3*MANIFEST_FIELD_LENGTH];
+  long n_catchments = 0;
+  long n_allocated = 64;
+  long line_number = 0;
+
+  if((fp=fopen(manifest_file,"r"))==NULL) {
+    printf("Can not open catchment manifest %s\n", manifest_file);
+    return -1;
+  }
+
+  *catchments = (catchment*) malloc(n_allocated * sizeof(catchment));
+  while(fgets(line, sizeof(line), fp) != NULL) {
+    catchment* c;
+    int n_fields;
+
+    line_number++;
+    if(n_catchments == n_allocated) {
+      n_allocated *= 2;
+      *catchments = (catchment*) realloc(*catchments, n_allocated * sizeof(catchment));
+    }
+    c = &(*catchments)[n_catchments];
+    c->forcing_file[0] = '\0';
+    n_fields = sscanf(line, "%1023s %1023s %1023s", c->id, c->config_file, c->forcing_file);
+    if(n_fields <= 0 || c->id[0] == '#')
+      continue;
+    if(n_fields < 2) {
+      printf("line %ld of %s needs a catchment id and a config file\n", line_number, manifest_file);
+      fclose(fp);
+      free(*catchments);
+      return -1;
+    }
+    c->n_steps = 0;
+    c->status = -1;
+    n_catchments++;
+  }
+  fclose(fp);
+
+  return n_catchments;
+}
+
+/**************************************************************************************************
+    Initialize like the BMI Initialize does, but with the forcing file of the manifest if it has one.
+**************************************************************************************************/
+static int initialize_catchment(Bmi* pet_bmi_model, const catchment* c)
+{
+  pet_model* pet = (pet_model *) pet_bmi_model->data;
+
+  if(c->forcing_file[0] == '\0')
+    return pet_bmi_model->initialize(pet_bmi_model, c->config_file);
+
+  if(read_init_config_pet(pet, c->config_file) == BMI_FAILURE)
+    return BMI_FAILURE;
+  pet->forcing_file = pet_model_strdup(pet, c->forcing_file);
+  pet->bmi.is_forcing_from_bmi = 0;
+
+  pet_setup(pet);
+  if(read_aorc_forcing_file_pet(pet, pet->forcing_file) != 0)
+    return BMI_FAILURE;
+  pet->bmi.current_step = 0;
+
+  return BMI_SUCCESS;
+}
+
+/**************************************************************************************************
+    Write the time and PET of every step to <output dir>/<catchment id>.csv (or .bin)
+**************************************************************************************************/
+static int write_catchment_output(const char* output_dir, int output_format, const catchment* c,
+                                  double start_time, double time_step_size_s, const double* pet_m_per_s)
+{
+  char output_file[2*MANIFEST_FIELD_LENGTH+8];
+  pet_output_options options;
+  pet_output* out;
+  int status;
+
+  memset(&options, 0, sizeof(options));
+  options.format = output_format;
+  options.layout = PET_OUTPUT_TIME_MAJOR;
+  options.fields = PET_OUTPUT_TIME | PET_OUTPUT_PET;
+  options.n_catchments = 1;
+
+  snprintf(output_file, sizeof(output_file), "%s/%s.%s", output_dir, c->id,
+           (output_format == PET_OUTPUT_BINARY) ? "bin" : "csv");
+  if((out = pet_output_open(output_file, &options)) == NULL) {
+    printf("Can not open output file %s for catchment %s\n", output_file, c->id);
+    return -1;
+  }
+
+  status = pet_output_write_series(out, 0, start_time, time_step_size_s, c->n_steps, pet_m_per_s);
+  if((status | pet_output_close(out)) != 0) {
+    printf("Error writing output file %s for catchment %s\n", output_file, c->id);
+    return -1;
+  }
+  return 0;
+}
+
+/**************************************************************************************************
+    Initialize, run and finalize one catchment.  Returns 0 on success, -1 on failure.
+**************************************************************************************************/
+static int run_catchment(const char* output_dir, int output_format, catchment* c, pet_arena_pool* arena_pool)
+{
+  Bmi* pet_bmi_model = (Bmi *) malloc(sizeof(Bmi));
+  pet_model* pet;
+  double* pet_m_per_s = NULL;
+  double start_time;
+  int status = -1;
+
+  register_bmi_pet(pet_bmi_model);
+  ((pet_model *) pet_bmi_model->data)->arena_pool = arena_pool;
+  if(initialize_catchment(pet_bmi_model, c) != BMI_SUCCESS) {
+    printf("Could not initialize catchment %s from %s\n", c->id, c->config_file);
+    goto done;
+  }
+  pet = (pet_model *) pet_bmi_model->data;
+  if(pet->bmi.is_forcing_from_bmi == 1) {
+    printf("Catchment %s: forcing_file=BMI needs a forcing file in the manifest\n", c->id);
+    goto done;
+  }
+
+  start_time = pet->bmi.current_time;
+  pet_m_per_s = (double *) malloc(pet->bmi.num_timesteps * sizeof(double));
+  c->n_steps = run_pet_series(pet, pet->bmi.num_timesteps, pet_m_per_s);
+  if(c->n_steps < 0)
+    goto done;
+
+  status = write_catchment_output(output_dir, output_format, c, start_time, pet->bmi.time_step_size_s, pet_m_per_s);
+
+done:
+  free(pet_m_per_s);
+  pet_bmi_model->finalize(pet_bmi_model);
+  free(pet_bmi_model->data);
+  free(pet_bmi_model);
+  return status;
+}
+
+static void* catchment_worker(void* arg)
+{
+  catchment_pool* pool = (catchment_pool *) arg;
+  pet_arena_pool* arena_pool = pet_arena_pool_create(1);   // only one catchment at a time on this thread
+
+  for(;;) {
+    long i;
+
+    pthread_mutex_lock(&pool->lock);
+    i = pool->next_catchment++;
+    pthread_mutex_unlock(&pool->lock);
+    if(i >= pool->n_catchments)
+      break;
+
+    pool->catchments[i].status = run_catchment(pool->output_dir, pool->output_format, &pool->catchments[i],
+                                               arena_pool);
+  }
+  pet_arena_pool_destroy(arena_pool);
+  return NULL;
+}
+
+int
+main(int argc, const char *argv[])
+{
+  catchment_pool pool;
+  pthread_t* threads;
+  long n_threads;
+  long n_failed = 0;
+  long i;
+
+  if(argc < 3) {
+    printf("usage: %s <manifest> <output dir> [number of threads, default all cores] [csv|binary]\n", argv[0]);
+    exit(1);
+  }
+
+  pool.n_catchments = read_manifest(argv[1], &pool.catchments);
+  if(pool.n_catchments < 0)
+    exit(1);
+  pool.next_catchment = 0;
+  pool.output_dir = argv[2];
+  pool.output_format = (argc > 4 && strcmp(argv[4], "binary") == 0) ? PET_OUTPUT_BINARY : PET_OUTPUT_CSV;
+  pthread_mutex_init(&pool.lock, NULL);
+
+  n_threads = (argc > 3) ? atol(argv[3]) : sysconf(_SC_NPROCESSORS_ONLN);
+  if(n_threads < 1)
+    n_threads = 1;
+  if(n_threads > pool.n_catchments)
+    n_threads = pool.n_catchments;
+
+  printf("running %ld catchments on %ld threads\n", pool.n_catchments, n_threads);
+
+  threads = (pthread_t *) malloc(n_threads * sizeof(pthread_t));
+  for(i = 0; i < n_threads; i++)
+    pthread_create(&threads[i], NULL, catchment_worker, &pool);
+  for(i = 0; i < n_threads; i++)
+    pthread_join(threads[i], NULL);
+
+  for(i = 0; i < pool.n_catchments; i++) {
+    if(pool.catchments[i].status != 0) {
+      printf("catchment %s FAILED\n", pool.catchments[i].id);
+      n_failed++;
+    }
+  }
+  printf("%ld of %ld catchments run, output in %s\n", pool.n_catchments - n_failed, pool.n_catchments, argv[2]);
+
+  pthread_mutex_destroy(&pool.lock);
+  free(threads);
+  free(pool.catchments);
+  return n_failed > 0 ? 1 : 0;
+}
@@ -5,32 +5,220 @@
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
-#include <time.h>
 
 //local includes
 #include "../include/pet.h"
+#include "../include/pet_arena.h"
+#include "../include/pet_log.h"
+#include "../include/pet_timing.h"
 #include "../include/pet_tools.h"
+#include "../include/pet_forcing.h"
+#include "../include/pet_batch.h"
 #include "../include/PEtEnergyBalanceMethod.h"
 #include "../include/PEtAerodynamicMethod.h"
 #include "../include/PEtCombinationMethod.h"
 #include "../include/PEtPriestleyTaylorMethod.h"
 #include "../include/PEtPenmanMonteithMethod.h"
 
-extern void alloc_pet_model(pet_model *model) {
-    // TODO: *******************
+extern int alloc_pet_model(pet_model *model) {
+    if (model->arena == NULL)
+        model->arena = pet_arena_create(model->arena_pool);
+    return model->arena != NULL ? 0 : -1;
 }
 
 extern void free_pet_model(pet_model *model) {
-    // TODO: ******************
+    // unmaps a binary forcing file, heap forcing arrays and the vector batch are in the arena
+    free_aorc_forcing_pet(model);
+    model->vector_batch = NULL;
+    model->solar_cache = NULL;
+    model->forcing_file = NULL;
+    model->catchment_configs = NULL;
+    pet_arena_destroy(model->arena);
+    model->arena = NULL;
 }
 
 // ######################    RUN    ########    RUN    ########    RUN    ########    RUN    #################################
 // ######################    RUN    ########    RUN    ########    RUN    ########    RUN    #################################
 // ######################    RUN    ########    RUN    ########    RUN    ########    RUN    #################################
 // ######################    RUN    ########    RUN    ########    RUN    ########    RUN    #################################
+// the row of the forcing arrays holding a timestep, refilling the window first if the forcing is streamed and the
+// timestep is outside it.  -1 if the forcing file could not be read.
+static long forcing_row(pet_model* model, long step)
+{
+  long row = step - model->forcing_block.first_row;
+
+  if (row >= 0 && row < model->forcing_block.n_rows)
+    return row;
+  return advance_forcing_window_pet(model, step);
+}
+
+// stage one row of the forcing arrays read from file, step is the row index
+static void stage_pet_forcing_from_arrays(pet_model* model, long step)
+{
+  model->pet_forcing.air_temperature_C = model->forcing_data_air_temperature_2m_K[step] - TK;//convert to C
+  model->pet_forcing.relative_humidity_percent     = (double)-99.9; // this negative number means use specific humidity
+  model->pet_forcing.specific_humidity_2m_kg_per_kg = model->forcing_data_precip_kg_per_m2[step];
+  model->pet_forcing.air_pressure_Pa    = model->forcing_data_surface_pressure_Pa[step];
+  model->pet_forcing.wind_speed_m_per_s = hypot(model->forcing_data_u_wind_speed_10m_m_per_s[step],
+                                         model->forcing_data_v_wind_speed_10m_m_per_s[step]);
+}
+
+// copy one row of the forcing arrays read from file into the aorc structure
+static void copy_aorc_forcing_from_arrays(pet_model* model, long step)
+{
+  model->aorc.incoming_longwave_W_per_m2     =  model->forcing_data_incoming_longwave_W_per_m2[step];
+  model->aorc.incoming_shortwave_W_per_m2    =  model->forcing_data_incoming_shortwave_W_per_m2[step];
+  model->aorc.surface_pressure_Pa            =  model->forcing_data_surface_pressure_Pa[step];
+  model->aorc.specific_humidity_2m_kg_per_kg =  model->forcing_data_specific_humidity_2m_kg_per_kg[step];
+  model->aorc.air_temperature_2m_K           =  model->forcing_data_air_temperature_2m_K[step];
+  model->aorc.u_wind_speed_10m_m_per_s       =  model->forcing_data_u_wind_speed_10m_m_per_s[step];
+  model->aorc.v_wind_speed_10m_m_per_s       =  model->forcing_data_v_wind_speed_10m_m_per_s[step];
+}
+
+static void stage_pet_forcing_from_aorc(pet_model* model)
+{
+  model->pet_forcing.air_temperature_C = model->aorc.air_temperature_2m_K - TK;//convert to C
+  model->pet_forcing.relative_humidity_percent     = (double)-99.9; // this negative number means use specific humidity
+  model->pet_forcing.specific_humidity_2m_kg_per_kg = model->aorc.specific_humidity_2m_kg_per_kg;
+  model->pet_forcing.air_pressure_Pa    = model->aorc.surface_pressure_Pa;
+  model->pet_forcing.wind_speed_m_per_s = hypot(model->aorc.u_wind_speed_10m_m_per_s, model->aorc.v_wind_speed_10m_m_per_s);
+}
+
+// saturation vapor pressure and the slope of its curve at the air temperature, with a single exponential.
+// Used by the relative humidity conversion below and by calculate_intermediate_variables().
+static void stage_saturation_vapor_pressure(pet_model* model)
+{
+  calc_air_saturation_vapor_pressure_and_slope_Pa(model->pet_forcing.air_temperature_C,
+                                                  &model->inter_vars.air_saturation_vapor_pressure_Pa,
+                                                  &model->inter_vars.slope_sat_vap_press_curve_Pa_s);
+}
+
+// everything run_pet does with the aorc forcing once it is in model->aorc
+static void stage_surface_radiation_forcing_from_aorc(pet_model* model)
+{
+  // jframe: not sure if this belongs here or not, but it needs to happen somewhere.
+  model->pet_forcing.specific_humidity_2m_kg_per_kg =  model->aorc.specific_humidity_2m_kg_per_kg;
+
+  model->aorc.latitude                       =  model->solar_params.latitude_degrees;
+  model->aorc.longitude                      =  model->solar_params.longitude_degrees;
+
+  // wind speed was measured at 10.0 m height, so we need to calculate the wind speed at 2.0m
+  model->pet_forcing.wind_speed_m_per_s *= model->derived_params.wind_speed_height_scale;  // this is the 2 m value
+  // transfer aorc forcing data into our data structure for surface radiation calculations
+  model->surf_rad_forcing.incoming_shortwave_radiation_W_per_sq_m = (double)model->aorc.incoming_shortwave_W_per_m2;
+  model->surf_rad_forcing.incoming_longwave_radiation_W_per_sq_m  = (double)model->aorc.incoming_longwave_W_per_m2; 
+  model->surf_rad_forcing.air_temperature_C                       = (double)model->aorc.air_temperature_2m_K-TK;
+
+  // compute relative humidity from specific humidity..
+  // surf_rad_forcing.air_temperature_C is the same as pet_forcing.air_temperature_C here, so reuse e_sat from above
+  double saturation_vapor_pressure_Pa = model->inter_vars.air_saturation_vapor_pressure_Pa;
+  double actual_vapor_pressure_Pa = (double)model->aorc.specific_humidity_2m_kg_per_kg*(double)model->aorc.surface_pressure_Pa/0.622;
+
+  model->surf_rad_forcing.relative_humidity_percent = 100.0*actual_vapor_pressure_Pa/saturation_vapor_pressure_Pa;
+  // sanity check the resulting value.  Should be less than 100%.  Sometimes air can be supersaturated.
+  if(100.0< model->surf_rad_forcing.relative_humidity_percent) model->surf_rad_forcing.relative_humidity_percent = 99.0;
+}
+
+// PET method kernels, one of these is bound to model->pet_method_kernel by pet_setup().
+// We must calculate the net radiation before calling the ET subroutine, except for the aerodynamic method.
+static double energy_balance_method_kernel(pet_model* model)
+{
+  PET_TIME_STAGE(model, PET_TIMING_NET_RADIATION,
+                 model->pet_forcing.net_radiation_W_per_sq_m=calculate_net_radiation_W_per_sq_m(model));
+  return pevapotranspiration_energy_balance_method(model);
+}
+
+static double aerodynamic_method_kernel(pet_model* model)
+{
+  return pevapotranspiration_aerodynamic_method(model);
+}
+
+static double combination_method_kernel(pet_model* model)
+{
+  PET_TIME_STAGE(model, PET_TIMING_NET_RADIATION,
+                 model->pet_forcing.net_radiation_W_per_sq_m=calculate_net_radiation_W_per_sq_m(model));
+  return pevapotranspiration_combination_method(model);
+}
+
+static double priestley_taylor_method_kernel(pet_model* model)
+{
+  PET_TIME_STAGE(model, PET_TIMING_NET_RADIATION,
+                 model->pet_forcing.net_radiation_W_per_sq_m=calculate_net_radiation_W_per_sq_m(model));
+  return pevapotranspiration_priestley_taylor_method(model);
+}
+
+static double penman_monteith_method_kernel(pet_model* model)
+{
+  PET_TIME_STAGE(model, PET_TIMING_NET_RADIATION,
+                 model->pet_forcing.net_radiation_W_per_sq_m=calculate_net_radiation_W_per_sq_m(model));
+  return pevapotranspiration_penman_monteith_method(model);
+}
+
+// pet_method is not one of the five methods, PET is left as it was
+static double no_method_kernel(pet_model* model)
+{
+  PET_TIME_STAGE(model, PET_TIMING_NET_RADIATION,
+                 model->pet_forcing.net_radiation_W_per_sq_m=calculate_net_radiation_W_per_sq_m(model));
+  return model->pet_m_per_s;
+}
+
+#if defined(PET_TIMING)
+// time the stages a method kernel calls have been given so far
+static void nested_pet_timing(const pet_model* model, double *ns, double *cycles)
+{
+  int stage;
+
+  *ns = *cycles = 0.0;
+  for (stage = PET_TIMING_NET_RADIATION; stage <= PET_TIMING_AERODYNAMIC_RESISTANCE; stage++) {
+    *ns += model->timing.ns[stage];
+    *cycles += model->timing.cycles[stage];
+  }
+}
+#endif
+
+// model->pet_m_per_s from the method kernel, which is timed without the stages it calls
+static void run_pet_method_kernel(pet_model* model)
+{
+#if defined(PET_TIMING)
+  double ns_before, cycles_before, ns_after, cycles_after;
+
+  nested_pet_timing(model, &ns_before, &cycles_before);
+  PET_TIMING_BEGIN(start);
+  model->pet_m_per_s=model->pet_method_kernel(model);
+  PET_TIMING_END(model, PET_TIMING_METHOD, start);
+  nested_pet_timing(model, &ns_after, &cycles_after);
+  model->timing.ns[PET_TIMING_METHOD] -= ns_after - ns_before;
+  model->timing.cycles[PET_TIMING_METHOD] -= cycles_after - cycles_before;
+#else
+  model->pet_m_per_s=model->pet_method_kernel(model);
+#endif
+}
+
+// radiation and PET from the staged forcing, result goes in model->pet_m_per_s
+static void calculate_pet_from_staged_forcing(pet_model* model)
+{
+  if(model->pet_options.shortwave_radiation_provided==0)
+  {
+    // populate the elements of the structures needed to calculate shortwave (solar) radiation, and calculate it
+    // ### OPTIONS ###
+    model->solar_options.cloud_base_height_known=0;  // set to TRUE if the solar_forcing.cloud_base_height_m is known.
+
+    PET_TIME_STAGE(model, PET_TIMING_SOLAR_RADIATION, calculate_solar_radiation(model));
+  }
+  
+  run_pet_method_kernel(model);
+
+  // prevent dew from forming (i.e., PET < 0)
+  if(model->pet_m_per_s<0) {
+    model->pet_m_per_s = 0;
+  }
+}
+
 extern int run_pet(pet_model* model)
 {
-  if (model->bmi.verbose >2){
+  long row = 0;
+
+  if (PET_LOG_ON(model, PET_LOG_DEBUG)){
     printf("Running the PET model \n");
     printf("model->bmi.is_forcing_from_bmi %d \n", model->bmi.is_forcing_from_bmi);
   }
@@ -43,98 +231,36 @@ extern int run_pet(pet_model* model)
                So we would delete the first block in this "if" statement,
                And move the "else" section below the model->aorc.forcings setting block.
   */
-  if (model->bmi.is_forcing_from_bmi == 0){
-    model->pet_forcing.air_temperature_C = model->forcing_data_air_temperature_2m_K[model->bmi.current_step] - TK;//convert to C
-    model->pet_forcing.relative_humidity_percent     = (double)-99.9; // this negative number means use specific humidity
-    model->pet_forcing.specific_humidity_2m_kg_per_kg = model->forcing_data_precip_kg_per_m2[model->bmi.current_step];
-    model->pet_forcing.air_pressure_Pa    = model->forcing_data_surface_pressure_Pa[model->bmi.current_step];
-    model->pet_forcing.wind_speed_m_per_s = hypot(model->forcing_data_u_wind_speed_10m_m_per_s[model->bmi.current_step],
-                                           model->forcing_data_v_wind_speed_10m_m_per_s[model->bmi.current_step]);                 
-  }
-  else{
-    model->pet_forcing.air_temperature_C = model->aorc.air_temperature_2m_K - TK;//convert to C
-    model->pet_forcing.relative_humidity_percent     = (double)-99.9; // this negative number means use specific humidity
-    model->pet_forcing.specific_humidity_2m_kg_per_kg = model->aorc.specific_humidity_2m_kg_per_kg;
-    model->pet_forcing.air_pressure_Pa    = model->aorc.surface_pressure_Pa;
-    model->pet_forcing.wind_speed_m_per_s = hypot(model->aorc.u_wind_speed_10m_m_per_s, model->aorc.v_wind_speed_10m_m_per_s);                 
+  PET_TIMING_BEGIN(forcing_start);
+  if (model->bmi.is_forcing_from_bmi == 0) {
+    row = forcing_row(model, model->bmi.current_step);
+    if (row < 0)
+      return -1;
+    stage_pet_forcing_from_arrays(model, row);
   }
+  else
+    stage_pet_forcing_from_aorc(model);
+
+  stage_saturation_vapor_pressure(model);
 
   if(model->pet_options.yes_aorc==1)
   {
-    if (model->bmi.verbose >1)
-        printf("YES AORC \n");
+    PET_LOG(model, PET_LOG_DETAIL, "YES AORC \n");
     
     /* jmframe: If we are getting forcing through BMI, then we don't need this, the forcings should already be in place */
-    if (model->bmi.is_forcing_from_bmi == 0){
-      model->aorc.incoming_longwave_W_per_m2     =  model->forcing_data_incoming_longwave_W_per_m2[model->bmi.current_step];
-      model->aorc.incoming_shortwave_W_per_m2    =  model->forcing_data_incoming_shortwave_W_per_m2[model->bmi.current_step];
-      model->aorc.surface_pressure_Pa            =  model->forcing_data_surface_pressure_Pa[model->bmi.current_step];
-      model->aorc.specific_humidity_2m_kg_per_kg =  model->forcing_data_specific_humidity_2m_kg_per_kg[model->bmi.current_step];
-      model->aorc.air_temperature_2m_K           =  model->forcing_data_air_temperature_2m_K[model->bmi.current_step];
-      model->aorc.u_wind_speed_10m_m_per_s       =  model->forcing_data_u_wind_speed_10m_m_per_s[model->bmi.current_step];
-      model->aorc.v_wind_speed_10m_m_per_s       =  model->forcing_data_v_wind_speed_10m_m_per_s[model->bmi.current_step];
-    }
+    if (model->bmi.is_forcing_from_bmi == 0)
+      copy_aorc_forcing_from_arrays(model, row);
 
-    // jframe: not sure if this belongs here or not, but it needs to happen somewhere.
-    model->pet_forcing.specific_humidity_2m_kg_per_kg =  model->aorc.specific_humidity_2m_kg_per_kg;
-
-    model->aorc.latitude                       =  model->solar_params.latitude_degrees;
-    model->aorc.longitude                      =  model->solar_params.longitude_degrees;
-
-    // wind speed was measured at 10.0 m height, so we need to calculate the wind speed at 2.0m
-    double numerator=log(2.0/model->pet_params.zero_plane_displacement_height_m);
-    double denominator=log(model->pet_params.wind_speed_measurement_height_m/model->pet_params.zero_plane_displacement_height_m);
-    model->pet_forcing.wind_speed_m_per_s = model->pet_forcing.wind_speed_m_per_s*numerator/denominator;  // this is the 2 m value
-    model->pet_params.wind_speed_measurement_height_m=2.0;  // change because we converted from 10m to 2m height.
-    // transfer aorc forcing data into our data structure for surface radiation calculations
-    model->surf_rad_forcing.incoming_shortwave_radiation_W_per_sq_m = (double)model->aorc.incoming_shortwave_W_per_m2;
-    model->surf_rad_forcing.incoming_longwave_radiation_W_per_sq_m  = (double)model->aorc.incoming_longwave_W_per_m2; 
-    model->surf_rad_forcing.air_temperature_C                       = (double)model->aorc.air_temperature_2m_K-TK;
-
-    // compute relative humidity from specific humidity..
-    double saturation_vapor_pressure_Pa = calc_air_saturation_vapor_pressure_Pa(model->surf_rad_forcing.air_temperature_C);
-    double actual_vapor_pressure_Pa = (double)model->aorc.specific_humidity_2m_kg_per_kg*(double)model->aorc.surface_pressure_Pa/0.622;
-
-    model->surf_rad_forcing.relative_humidity_percent = 100.0*actual_vapor_pressure_Pa/saturation_vapor_pressure_Pa;
-    // sanity check the resulting value.  Should be less than 100%.  Sometimes air can be supersaturated.
-    if(100.0< model->surf_rad_forcing.relative_humidity_percent) model->surf_rad_forcing.relative_humidity_percent = 99.0;
+    stage_surface_radiation_forcing_from_aorc(model);
   }
+  PET_TIMING_END(model, PET_TIMING_FORCING, forcing_start);
 
-  if(model->pet_options.shortwave_radiation_provided==0)
-  {
-    // populate the elements of the structures needed to calculate shortwave (solar) radiation, and calculate it
-    // ### OPTIONS ###
-    model->solar_options.cloud_base_height_known=0;  // set to TRUE if the solar_forcing.cloud_base_height_m is known.
+  if(model->pet_options.use_aerodynamic_method==0)
+    PET_LOG(model, PET_LOG_DETAIL, "calculate the net radiation before calling the PET subroutine");
 
-    calculate_solar_radiation(model);
-  }
-  
-  // we must calculate the net radiation before calling the ET subroutine.
-  if(model->pet_options.use_aerodynamic_method==0) 
-  {
-    if (model->bmi.verbose > 1)
-      printf("calculate the net radiation before calling the PET subroutine");
-    // NOTE don't call this function use_aerodynamic_method option is TRUE
-    model->pet_forcing.net_radiation_W_per_sq_m=calculate_net_radiation_W_per_sq_m(model);
-  }
-
-  if(model->pet_options.use_energy_balance_method ==1)
-    model->pet_m_per_s=pevapotranspiration_energy_balance_method(model);
-  if(model->pet_options.use_aerodynamic_method ==1)
-    model->pet_m_per_s=pevapotranspiration_aerodynamic_method(model);
-  if(model->pet_options.use_combination_method ==1)
-    model->pet_m_per_s=pevapotranspiration_combination_method(model);
-  if(model->pet_options.use_priestley_taylor_method ==1)
-    model->pet_m_per_s=pevapotranspiration_priestley_taylor_method(model);
-  if(model->pet_options.use_penman_monteith_method ==1)
-    model->pet_m_per_s=pevapotranspiration_penman_monteith_method(model);
-
-  // prevent dew from forming (i.e., PET < 0)
-  if(model->pet_m_per_s<0) {
-    model->pet_m_per_s = 0;
-  }
+  calculate_pet_from_staged_forcing(model);
 
-  if (model->bmi.verbose >=1){
+  if (PET_LOG_ON(model, PET_LOG_INFO)){
     printf("\n");
     printf("_______________________________________________________________________________\n");
     if(model->pet_options.use_energy_balance_method ==1)   printf("energy balance method:\n");
@@ -144,14 +270,241 @@ extern int run_pet(pet_model* model)
     if(model->pet_options.use_penman_monteith_method ==1)  printf("Penman Monteith method:\n");
 
     printf("calculated instantaneous potential evapotranspiration (PET) =%8.6e m/s\n",model->pet_m_per_s);
-    if (model->bmi.verbose > 1)
-      printf("calculated instantaneous potential evapotranspiration (PET) =%8.6lf mm/d\n",model->pet_m_per_s*86400.0*1000.0);
+    PET_LOG(model, PET_LOG_DETAIL, "calculated instantaneous potential evapotranspiration (PET) =%8.6lf mm/d\n",
+            model->pet_m_per_s*86400.0*1000.0);
   
   }
 
   return 0;
 }
 
+//####################################################################################################################
+// Run the model over n_steps consecutive rows of the forcing read from file, starting at bmi.current_step, and write
+// the PET (m/s) of each step to pet_m_per_s_out[0..n_steps-1].  Gives the same numbers as calling Update n_steps times
+// but without the per step branching and BMI overhead, and without any printing.  The run is cut short at the end of
+// the loaded forcing.  A streamed forcing file is refilled as the run goes.  Model time is advanced as Update would.
+// Returns the number of steps run, or -1 if the forcing comes in through BMI and there is nothing loaded to run over,
+// or if a streamed forcing file could not be read (current_step is then left at the step that failed).
+//####################################################################################################################
+extern long run_pet_series(pet_model* model, long n_steps, double *pet_m_per_s_out)
+{
+  long k, step, row;
+
+  if (model->bmi.is_forcing_from_bmi == 1){
+    printf("ERROR: run_pet_series needs the forcing read from file, forcing_file is BMI\n");
+    return -1;
+  }
+
+  if (n_steps > model->bmi.num_timesteps - model->bmi.current_step)
+    n_steps = model->bmi.num_timesteps - model->bmi.current_step;
+  if (n_steps < 0)
+    n_steps = 0;
+
+  step = model->bmi.current_step;
+  if(model->pet_options.yes_aorc==1)
+  {
+    for (k = 0; k < n_steps; k++, step++)
+    {
+      PET_TIMING_BEGIN(forcing_start);
+      if ((row = forcing_row(model, step)) < 0)
+        break;
+      copy_aorc_forcing_from_arrays(model, row);
+      stage_pet_forcing_from_aorc(model);
+      stage_saturation_vapor_pressure(model);
+      stage_surface_radiation_forcing_from_aorc(model);
+      PET_TIMING_END(model, PET_TIMING_FORCING, forcing_start);
+      calculate_pet_from_staged_forcing(model);
+      pet_m_per_s_out[k] = model->pet_m_per_s;
+      aggregate_pet_step(model);
+
+      model->bmi.current_time_step += model->bmi.time_step_size_s;
+      model->bmi.current_time      += model->bmi.time_step_size_s;
+    }
+  }
+  else
+  {
+    for (k = 0; k < n_steps; k++, step++)
+    {
+      PET_TIMING_BEGIN(forcing_start);
+      if ((row = forcing_row(model, step)) < 0)
+        break;
+      stage_pet_forcing_from_arrays(model, row);
+      stage_saturation_vapor_pressure(model);
+      PET_TIMING_END(model, PET_TIMING_FORCING, forcing_start);
+      calculate_pet_from_staged_forcing(model);
+      pet_m_per_s_out[k] = model->pet_m_per_s;
+      aggregate_pet_step(model);
+
+      model->bmi.current_time_step += model->bmi.time_step_size_s;
+      model->bmi.current_time      += model->bmi.time_step_size_s;
+    }
+  }
+  model->bmi.current_step = step;
+
+  return (k == n_steps) ? n_steps : -1;
+}
+
+//####################################################################################################################
+// Totals of the per stage timing, see pet_timing.h
+//####################################################################################################################
+const char *pet_timing_stage_names[PET_TIMING_N_STAGES] = {
+  "forcing",
+  "solar_radiation",
+  "net_radiation",
+  "intermediate_variables",
+  "aerodynamic_resistance",
+  "method"
+};
+
+extern void print_pet_timing(const pet_model* model, const char* title)
+{
+  int stage;
+  double total_ns = 0.0;
+
+  for (stage = 0; stage < PET_TIMING_N_STAGES; stage++)
+    total_ns += model->timing.ns[stage];
+  printf("PET stage timing of %s: %.3f ms in %.0f steps\n", title, total_ns * 1.0e-6,
+         model->timing.calls[PET_TIMING_METHOD]);
+  for (stage = 0; stage < PET_TIMING_N_STAGES; stage++)
+    if (model->timing.calls[stage] > 0.0)
+      printf("  %-24s %12.0f calls %12.1f ns/call %12.1f cycles/call %6.2f%%\n", pet_timing_stage_names[stage],
+             model->timing.calls[stage], model->timing.ns[stage] / model->timing.calls[stage],
+             model->timing.cycles[stage] / model->timing.calls[stage],
+             total_ns > 0.0 ? 100.0 * model->timing.ns[stage] / total_ns : 0.0);
+}
+
+//####################################################################################################################
+// Daily, monthly and cumulative PET depth, kept online so that a coupler can sample them once a day instead of
+// reading the flux every step.  A step counts in the UTC day and calendar month it starts in, and the step that
+// reaches the end of a day (month) closes it, so its total can be read right after the Update of its last step.  The
+// first day and month of a run are partial if it starts part way through them.  The sums are compensated (Kahan), so
+// that a multi-decade cumulative total of hourly steps stays within a rounding of the exact sum; this relies on the
+// compiler not reassociating floating point (no -ffast-math).
+//####################################################################################################################
+static void add_compensated_pet(double *sum, double *compensation, double value)
+{
+  double corrected = value - *compensation;
+  double new_sum = *sum + corrected;
+
+  *compensation = (new_sum - *sum) - corrected;
+  *sum = new_sum;
+}
+
+extern void pet_step_ends_period(double step_time_s, double time_step_size_s, int *ends_day, int *ends_month)
+{
+  int64_t day = (int64_t)floor(step_time_s / 86400.0);
+  int64_t next_day = (int64_t)floor((step_time_s + time_step_size_s) / 86400.0);
+  long year, month, day_of_month, next_year, next_month;
+
+  *ends_day = next_day != day;
+  *ends_month = 0;
+  if (*ends_day) {
+    epoch_days_to_civil_pet(day, &year, &month, &day_of_month);
+    epoch_days_to_civil_pet(next_day, &next_year, &next_month, &day_of_month);
+    *ends_month = next_month != month || next_year != year;
+  }
+}
+
+extern void accumulate_pet_depth(struct pet_aggregates *aggregates, double depth_m, int ends_day, int ends_month)
+{
+  add_compensated_pet(&aggregates->day_m, &aggregates->day_compensation_m, depth_m);
+  add_compensated_pet(&aggregates->month_m, &aggregates->month_compensation_m, depth_m);
+  add_compensated_pet(&aggregates->cumulative_m, &aggregates->cumulative_compensation_m, depth_m);
+  if (ends_day) {
+    aggregates->daily_m = aggregates->day_m;
+    aggregates->day_m = 0.0;
+    aggregates->day_compensation_m = 0.0;
+  }
+  if (ends_month) {
+    aggregates->monthly_m = aggregates->month_m;
+    aggregates->month_m = 0.0;
+    aggregates->month_compensation_m = 0.0;
+  }
+}
+
+extern void aggregate_pet_step(pet_model* model)
+{
+  int ends_day, ends_month;
+
+  pet_step_ends_period(model->bmi.current_time, (double)model->bmi.time_step_size_s, &ends_day, &ends_month);
+  accumulate_pet_depth(&model->aggregates, model->pet_m_per_s * model->bmi.time_step_size_s, ends_day, ends_month);
+}
+
+//####################################################################################################################
+// Everything the time step calculations need from pet_params that does not change with the forcing: the AORC wind
+// height conversion, the sanity checked heights and roughness lengths, and the logarithms of the aerodynamic and
+// Penman-Monteith methods.  pet_params itself is left as it was read from the config, so running pet_setup() again
+// on the same parameters gives the same results.
+//####################################################################################################################
+static void compute_derived_params_pet(pet_model* model)
+{
+  struct pevapotranspiration_derived_params* derived = &model->derived_params;
+  double zm = model->pet_params.wind_speed_measurement_height_m;
+  double zh = model->pet_params.humidity_measurement_height_m;
+  double d  = model->pet_params.zero_plane_displacement_height_m;
+  double zom = model->pet_params.momentum_transfer_roughness_length_m;
+  double zoh = model->pet_params.heat_transfer_roughness_length_m;
+
+  // input sanity checks.
+  if(1.0e-06 >= zm) zm=2.0;  // standard measurement height
+  if(1.0e-06 >= zh) zh=2.0;  // standard measurement height
+
+  // AORC wind speed was measured at 10.0 m height and is converted to 2.0 m, which is the height the methods then see.
+  derived->wind_speed_height_scale = 1.0;
+  if(model->pet_options.yes_aorc==1)
+  {
+    derived->wind_speed_height_scale = log(2.0/d)/log(zm/d);
+    zm=2.0;
+  }
+
+  if(model->pet_method==5)
+  {
+    if(is_fabs_less_than_eps(model->pet_params.vegetation_height_m,1.0e-06)==TRUE)
+    {
+      // the vegetation height was not specified.  It is not used below, the heights come from d.  TODO should warn??
+      fprintf(stderr,"WARNING: Vegetation height not specified in the Penman-Monteith routine.  Using 0.5m.\n");
+    }
+
+    // use approximations from UN FAO: http://www.fao.org/3/X0490E/x0490e06.htm#aerodynamic%20resistance%20(ra)
+    //zero_plane_displacement_height_m=2.0/3.0*vegetation_height_m; //wwu
+    //momentum_transfer_roughness_length_m=0.123*vegetation_height_m; //wwu
+    zom=0.1845*d;  //wwu
+    zoh=0.1*zom;
+
+    if(1.0e-06 >= zom && !(model->warnings_issued & PET_WARNING_TINY_MOMENTUM_ROUGHNESS))
+    {
+      model->warnings_issued |= PET_WARNING_TINY_MOMENTUM_ROUGHNESS;
+      fprintf(stderr,"momentum_transfer_roughness_length_m is tiny in calculate_aerodynamic_resistance().  Should not be tiny.\n");
+    }
+    if(1.0e-06 >= zoh && !(model->warnings_issued & PET_WARNING_TINY_HEAT_ROUGHNESS))
+    {
+      model->warnings_issued |= PET_WARNING_TINY_HEAT_ROUGHNESS;
+      fprintf(stderr,"heat_transfer_roughness_length_m is tiny in calculate_aerodynamic_resistance().  Should not be tiny.\n");
+    }
+  }
+
+  // IF HEAT/MOMENTUM ROUGHNESS LENGTHS NOT GIVEN, USE DEFAULTS SO THAT THEIR RATIO IS EQUAL TO 1.
+  if((1.0e-06 > zoh) || (1.0e-06 > zom))  // zero should be passed down if these are unknown
+  {
+    zoh=1.0;  // decent default values, and the ratio of these is 1.0
+    zom=1.0;
+  }
+
+  // the aerodynamic and combination methods use the unclamped displacement height
+  derived->aerodynamic_log_squared = pow(log(zm/d),2.0);
+
+  // add a necessary condition for ra calculation
+  // TODO: check zero displacement height (parsing from config_file?)
+  if(d >= zh) d = 2.0/3.0 * zh;
+
+  derived->wind_speed_measurement_height_m      = zm;
+  derived->humidity_measurement_height_m        = zh;
+  derived->zero_plane_displacement_height_m     = d;
+  derived->momentum_transfer_roughness_length_m = zom;
+  derived->heat_transfer_roughness_length_m     = zoh;
+  derived->aerodynamic_resistance_log_product   = log((zm-d)/zom)*log((zh-d)/zoh);
+}
+
 //########################    SETUP    ########    SETUP    ########    SETUP    ########################################
 //########################    SETUP    ########    SETUP    ########    SETUP    ########################################
 //########################    SETUP    ########    SETUP    ########    SETUP    ########################################
@@ -178,6 +531,19 @@ void pet_setup(pet_model* model)
   if (model->pet_method == 5)
     model->pet_options.use_penman_monteith_method  = 1;
 
+  // bind the method once here so that the per step path does not test the flags above
+  switch (model->pet_method)
+  {
+    case 1:  model->pet_method_kernel = energy_balance_method_kernel;   break;
+    case 2:  model->pet_method_kernel = aerodynamic_method_kernel;      break;
+    case 3:  model->pet_method_kernel = combination_method_kernel;      break;
+    case 4:  model->pet_method_kernel = priestley_taylor_method_kernel; break;
+    case 5:  model->pet_method_kernel = penman_monteith_method_kernel;  break;
+    default: model->pet_method_kernel = no_method_kernel;               break;
+  }
+
+  compute_derived_params_pet(model);
+
 
   //###################################################################################################
   // These data now come from aorc reading/parsing function.
@@ -241,6 +607,10 @@ void pet_setup(pet_model* model)
     model->surf_rad_forcing.atmospheric_turbidity_factor =   2.0;   // 2.0 = clear mountain air, 5.0= smoggy air
     model->surf_rad_forcing.day_of_year                  =  208;    // THESE VALUES ARE FOR THE UNIT TEST
     model->surf_rad_forcing.zulu_time                  =  20.567; // THESE VALUES ARE FOR THE UNIT TEST
+
+    // the sun position depends only on the site, day of year and hour, so it can be tabulated once here
+    if(model->solar_options.cache_solar_geometry==1)
+      build_solar_geometry_cache(model);
   
     // UNIT TEST RESULTS
     // CALCULATED SOLAR FLUXES
@@ -326,27 +696,7 @@ void parse_aorc_line_pet(char *theString, long *year, long *month, long *day, lo
 
     // time
     value = strsep(&copy, ",");
-    // TODO: handle this
-    // struct tm{
-    //   int tm_year;
-    //   int tm_mon; 
-    //   int tm_mday; 
-    //   int tm_hour; 
-    //   int tm_min; 
-    //   int tm_sec; 
-    //   int tm_isdst;
-    // } t;
-    struct tm t;
-    time_t t_of_day;
-
-    t.tm_year = (int)strtol(strsep(&value, "-"), NULL, 10) - 1900;
-    t.tm_mon = (int)strtol(strsep(&value, "-"), NULL, 10);
-    t.tm_mday = (int)strtol(strsep(&value, " "), NULL, 10);
-    t.tm_hour = (int)strtol(strsep(&value, ":"), NULL, 10);
-    t.tm_min = (int)strtol(strsep(&value, ":"), NULL, 10);
-    t.tm_sec = (int)strtol(value, NULL, 10);
-    t.tm_isdst = -1;        // Is DST on? 1 = yes, 0 = no, -1 = unknown
-    aorc->time = mktime(&t);
+    parse_timestamp_pet(value, &aorc->time);  // seconds since 1970 UTC
 
     // APCP_surface
     value = strsep(&copy, ",");
@@ -556,12 +906,9 @@ double greg_2_jul_pet(
 }
 
 /* Julian date converter. Takes a julian date (the number of days since
-** some distant epoch or other), and returns an int pointer to static space.
-** ip[0] = month;
-** ip[1] = day of month;
-** ip[2] = year (actual year, like 1977, not 77 unless it was  77 a.d.);
-** ip[3] = day of week (0->Sunday to 6->Saturday)
-** These are Gregorian.
+** some distant epoch or other), and returns the Gregorian year, month,
+** day of month, hour, minute and second through the pointers.
+** Keeps no state between calls, so it is safe to call from several threads.
 ** Copied from Algorithm 199 in Collected algorithms of the CACM
 ** Author: Robert G. Tantzen, Translator: Nat Howard
 **
@@ -570,8 +917,6 @@ double greg_2_jul_pet(
 */
 void calc_date_pet(double jd, long *y, long *m, long *d, long *h, long *mi,
                double *sec) {
-    static int ret[4];
-
     long j;
     double tmp;
     double frac;
@@ -586,7 +931,6 @@ void calc_date_pet(double jd, long *y, long *m, long *d, long *h, long *mi,
         frac = frac + 0.5;
     }
 
-    ret[3] = (j + 1L) % 7L;
     j -= 1721119L;
     *y = (4L * j - 1L) / 146097L;
     j = 4L * j - 1L - 146097L * *y;
@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../include/pet.h"
+#include "../include/pet_arena.h"
+
+struct pet_arena_block {
+  struct pet_arena_block *next;
+  void   *raw;    // what malloc returned, the block itself starts at the next PET_ARENA_ALIGNMENT boundary
+  size_t  size;   // usable bytes after the header
+  size_t  used;
+};
+
+// the block header rounded up, so that the first allocation of a block is aligned as well
+#define PET_ARENA_HEADER_SIZE \
+  ((sizeof(struct pet_arena_block) + PET_ARENA_ALIGNMENT - 1) / PET_ARENA_ALIGNMENT * PET_ARENA_ALIGNMENT)
+
+struct pet_arena {
+  struct pet_arena_block *blocks;   // in the order they were added
+  pet_arena_pool         *pool;     // the arena goes back here when destroyed, may be NULL
+  pet_arena              *next;     // next arena on the free list of the pool
+};
+
+struct pet_arena_pool {
+  pet_arena *free_arenas;
+  int        n_free;
+  int        max_free;
+};
+
+static size_t round_up_to_alignment(size_t size)
+{
+  return (size + PET_ARENA_ALIGNMENT - 1) / PET_ARENA_ALIGNMENT * PET_ARENA_ALIGNMENT;
+}
+
+static struct pet_arena_block *new_arena_block(size_t size)
+{
+  void *raw = malloc(PET_ARENA_HEADER_SIZE + size + PET_ARENA_ALIGNMENT - 1);
+  struct pet_arena_block *block;
+
+  if (raw == NULL) {
+    printf("Problem allocating a block of %lu bytes for a PET instance\n", (unsigned long)size);
+    return NULL;
+  }
+  block = (struct pet_arena_block *)round_up_to_alignment((size_t)(uintptr_t)raw);
+  block->next = NULL;
+  block->raw  = raw;
+  block->size = size;
+  block->used = 0;
+  return block;
+}
+
+static void free_arena_blocks(pet_arena *arena)
+{
+  struct pet_arena_block *block = arena->blocks;
+
+  while (block != NULL) {
+    struct pet_arena_block *next = block->next;
+    free(block->raw);
+    block = next;
+  }
+  arena->blocks = NULL;
+}
+
+//#####################################################################################################################
+
+extern pet_arena *pet_arena_create(pet_arena_pool *pool)
+{
+  pet_arena *arena;
+
+  if (pool != NULL && pool->free_arenas != NULL) {
+    arena = pool->free_arenas;
+    pool->free_arenas = arena->next;
+    pool->n_free--;
+    arena->next = NULL;
+    return arena;
+  }
+
+  arena = (pet_arena *) calloc(1, sizeof(pet_arena));
+  if (arena == NULL) {
+    printf("Problem allocating the memory arena of a PET instance\n");
+    return NULL;
+  }
+  arena->pool = pool;
+  return arena;
+}
+
+extern void *pet_arena_alloc(pet_arena *arena, size_t size)
+{
+  struct pet_arena_block *block, *last = NULL;
+  char *data;
+
+  size = round_up_to_alignment(size > 0 ? size : 1);
+
+  // first fit, the list is short and a recycled arena has room all the way along it
+  for (block = arena->blocks; block != NULL; last = block, block = block->next)
+    if (block->size - block->used >= size)
+      break;
+
+  if (block == NULL) {
+    block = new_arena_block(size > PET_ARENA_BLOCK_SIZE/2 ? size : PET_ARENA_BLOCK_SIZE);
+    if (block == NULL)
+      return NULL;
+    if (last == NULL)
+      arena->blocks = block;
+    else
+      last->next = block;
+  }
+
+  data = (char *)block + PET_ARENA_HEADER_SIZE + block->used;
+  block->used += size;
+  memset(data, 0, size);
+  return data;
+}
+
+extern char *pet_arena_strdup(pet_arena *arena, const char *s)
+{
+  size_t length = strlen(s) + 1;
+  char *copy = (char *) pet_arena_alloc(arena, length);
+
+  if (copy != NULL)
+    memcpy(copy, s, length);
+  return copy;
+}
+
+extern size_t pet_arena_reserved_bytes(const pet_arena *arena)
+{
+  const struct pet_arena_block *block;
+  size_t bytes = 0;
+
+  for (block = arena->blocks; block != NULL; block = block->next)
+    bytes += block->size;
+  return bytes;
+}
+
+extern void pet_arena_destroy(pet_arena *arena)
+{
+  pet_arena_pool *pool;
+  struct pet_arena_block *block;
+
+  if (arena == NULL)
+    return;
+
+  pool = arena->pool;
+  if (pool != NULL && pool->n_free < pool->max_free) {
+    // keep the blocks, the next instance starts filling them from the front
+    for (block = arena->blocks; block != NULL; block = block->next)
+      block->used = 0;
+    arena->next = pool->free_arenas;
+    pool->free_arenas = arena;
+    pool->n_free++;
+    return;
+  }
+
+  free_arena_blocks(arena);
+  free(arena);
+}
+
+extern pet_arena_pool *pet_arena_pool_create(int max_arenas)
+{
+  pet_arena_pool *pool = (pet_arena_pool *) calloc(1, sizeof(pet_arena_pool));
+
+  if (pool != NULL)
+    pool->max_free = max_arenas > 0 ? max_arenas : 0;
+  return pool;
+}
+
+extern void pet_arena_pool_destroy(pet_arena_pool *pool)
+{
+  if (pool == NULL)
+    return;
+
+  while (pool->free_arenas != NULL) {
+    pet_arena *arena = pool->free_arenas;
+    pool->free_arenas = arena->next;
+    free_arena_blocks(arena);
+    free(arena);
+  }
+  free(pool);
+}
+
+//#####################################################################################################################
+
+extern void *pet_model_alloc(pet_model *model, size_t size)
+{
+  if (model->arena == NULL && (model->arena = pet_arena_create(model->arena_pool)) == NULL)
+    return NULL;
+  return pet_arena_alloc(model->arena, size);
+}
+
+extern char *pet_model_strdup(pet_model *model, const char *s)
+{
+  if (model->arena == NULL && (model->arena = pet_arena_create(model->arena_pool)) == NULL)
+    return NULL;
+  return pet_arena_strdup(model->arena, s);
+}
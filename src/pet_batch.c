@@ -0,0 +1,391 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+#include "../include/pet.h"
+#include "../include/pet_batch.h"
+#include "../include/pet_simd.h"
+
+//#####################################################################################################################
+// The sweeps below follow run_pet() and the functions it calls in pet_tools.h and the PEt*Method.h headers, one
+// stage at a time, so that every loop body is straight-line arithmetic over contiguous arrays.  Keep them in step
+// with the scalar code.
+//#####################################################################################################################
+
+// populate pet_forcing and surf_rad_forcing from the AORC forcing, see the yes_aorc block of run_pet().
+static void pet_batch_stage_forcing(pet_batch *batch)
+{
+  long n = batch->n_catchments;
+  const struct pet_batch_forcing *aorc = &batch->forcing;
+  const struct pet_batch_params *params = &batch->pet_params;
+  struct pet_batch_pet_forcing *pf = &batch->pet_forcing;
+  struct pet_batch_surf_rad_forcing *srf = &batch->surf_rad_forcing;
+  struct pet_batch_inter_vars *iv = &batch->inter_vars;
+
+  for (long i = 0; i < n; i++)
+  {
+    pf->air_temperature_C[i]              = aorc->air_temperature_2m_K[i] - TK;
+    pf->specific_humidity_2m_kg_per_kg[i] = aorc->specific_humidity_2m_kg_per_kg[i];
+    pf->air_pressure_Pa[i]                = aorc->surface_pressure_Pa[i];
+    pf->wind_speed_m_per_s[i]             = hypot(aorc->u_wind_speed_10m_m_per_s[i], aorc->v_wind_speed_10m_m_per_s[i]);
+
+    // wind speed was measured at 10.0 m height, so we need to calculate the wind speed at 2.0m
+    pf->wind_speed_m_per_s[i] *= params->wind_speed_height_scale[i];
+
+    srf->incoming_shortwave_radiation_W_per_sq_m[i] = aorc->incoming_shortwave_W_per_m2[i];
+    srf->incoming_longwave_radiation_W_per_sq_m[i]  = aorc->incoming_longwave_W_per_m2[i];
+    srf->air_temperature_C[i]                       = aorc->air_temperature_2m_K[i] - TK;
+  }
+
+  // saturation vapor pressure and its slope for every catchment, one exponential each.
+  calc_air_saturation_vapor_pressure_and_slope_array(pf->air_temperature_C, iv->air_saturation_vapor_pressure_Pa,
+                                                     iv->slope_sat_vap_press_curve_Pa_s, n);
+
+  for (long i = 0; i < n; i++)
+  {
+    double actual_vapor_pressure_Pa;
+
+    // compute relative humidity from specific humidity..
+    // surf_rad_forcing.air_temperature_C is the same as pet_forcing.air_temperature_C, so reuse e_sat from above
+    actual_vapor_pressure_Pa = aorc->specific_humidity_2m_kg_per_kg[i]*aorc->surface_pressure_Pa[i]/0.622;
+    srf->relative_humidity_percent[i] = 100.0*actual_vapor_pressure_Pa/iv->air_saturation_vapor_pressure_Pa[i];
+    if (100.0 < srf->relative_humidity_percent[i]) srf->relative_humidity_percent[i] = 99.0;
+  }
+}
+
+// see calculate_net_radiation_W_per_sq_m(), AORC branch: incoming longwave is measured.
+static void pet_batch_net_radiation(pet_batch *batch)
+{
+  long n = batch->n_catchments;
+  const struct pet_batch_params *params = &batch->pet_params;
+  const struct pet_batch_surf_rad_forcing *srf = &batch->surf_rad_forcing;
+  double *net_radiation_W_per_sq_m = batch->pet_forcing.net_radiation_W_per_sq_m;
+
+  for (long i = 0; i < n; i++)
+  {
+    double outgoing_longwave_radiation_W_per_sq_m = params->surface_longwave_emissivity[i]*SB*
+                                                    pow(srf->surface_skin_temperature_C[i]+TK,4.0);
+    double surface_longwave_albedo = (0.999 < params->surface_longwave_emissivity[i]) ? 0.0 : 0.03;
+
+    net_radiation_W_per_sq_m[i] = (1.0-params->surface_shortwave_albedo[i])*
+                                  srf->incoming_shortwave_radiation_W_per_sq_m[i] +
+                                  (1.0-surface_longwave_albedo)*srf->incoming_longwave_radiation_W_per_sq_m[i] -
+                                  outgoing_longwave_radiation_W_per_sq_m;
+  }
+}
+
+// water density and latent heat, the part of calculate_intermediate_variables() the energy balance method needs.
+static void pet_batch_water_properties(pet_batch *batch)
+{
+  long n = batch->n_catchments;
+  double *water_temperature_C = batch->pet_forcing.water_temperature_C;
+  struct pet_batch_inter_vars *iv = &batch->inter_vars;
+
+  for (long i = 0; i < n; i++)
+  {
+    double rho_w;
+
+    // IF SOIL WATER TEMPERATURE NOT PROVIDED, USE A SANE VALUE
+    if (100.0 > water_temperature_C[i]) water_temperature_C[i] = 22.0;
+
+    rho_w = 1.0/(0.0009998492+4.9716595e-09*water_temperature_C[i]*water_temperature_C[i]);
+    if (1000 < rho_w) rho_w = 1000.0;
+
+    iv->liquid_water_density_kg_per_m3[i]             = rho_w;
+    iv->water_latent_heat_of_vaporization_J_per_kg[i] = 2.501e+06-2370.0*water_temperature_C[i];
+  }
+}
+
+// see calculate_intermediate_variables(), specific humidity branch.
+static void pet_batch_intermediate_variables(pet_batch *batch)
+{
+  long n = batch->n_catchments;
+  const struct pet_batch_params *params = &batch->pet_params;
+  const struct pet_batch_pet_forcing *pf = &batch->pet_forcing;
+  struct pet_batch_inter_vars *iv = &batch->inter_vars;
+
+  pet_batch_water_properties(batch);
+
+  for (long i = 0; i < n; i++)
+  {
+    double T = pf->air_temperature_C[i];
+    double e_sat = iv->air_saturation_vapor_pressure_Pa[i];  // from pet_batch_stage_forcing()
+    double e_act, R_a;
+
+    e_act = pf->specific_humidity_2m_kg_per_kg[i]*pf->air_pressure_Pa[i]/0.622;
+    if (e_act > e_sat) e_act = 0.65*e_sat;  // actual vapor pressure should not be higher than saturated value
+
+    R_a = 287.0*(1.0+0.608*pf->specific_humidity_2m_kg_per_kg[i]);
+
+    iv->air_actual_vapor_pressure_Pa[i]      = e_act;
+    iv->vapor_pressure_deficit_Pa[i]         = e_sat - e_act;
+    iv->moist_air_gas_constant_J_per_kg_K[i] = R_a;
+    iv->moist_air_density_kg_per_m3[i]       = pf->air_pressure_Pa[i]/(R_a*(T+TK));
+    iv->psychrometric_constant_Pa_per_C[i]   = CP*pf->air_pressure_Pa[i]*params->heat_transfer_roughness_length_m[i]/
+                                               (0.622*iv->water_latent_heat_of_vaporization_J_per_kg[i]);
+  }
+}
+
+// see pevapotranspiration_energy_balance_method()
+static void pet_batch_energy_balance_method(pet_batch *batch)
+{
+  long n = batch->n_catchments;
+  const struct pet_batch_inter_vars *iv = &batch->inter_vars;
+
+  pet_batch_water_properties(batch);
+
+  for (long i = 0; i < n; i++)
+    batch->pet_m_per_s[i] = batch->pet_forcing.net_radiation_W_per_sq_m[i]/
+                            (iv->liquid_water_density_kg_per_m3[i]*iv->water_latent_heat_of_vaporization_J_per_kg[i]);
+}
+
+// see pevapotranspiration_aerodynamic_method() and pevapotranspiration_combination_method()
+static void pet_batch_aerodynamic_and_combination_method(pet_batch *batch, int use_combination)
+{
+  long n = batch->n_catchments;
+  const struct pet_batch_params *params = &batch->pet_params;
+  const struct pet_batch_pet_forcing *pf = &batch->pet_forcing;
+  const struct pet_batch_inter_vars *iv = &batch->inter_vars;
+
+  pet_batch_intermediate_variables(batch);
+
+  for (long i = 0; i < n; i++)
+  {
+    double mass_flux = 0.622*KV2*iv->moist_air_density_kg_per_m3[i]*iv->vapor_pressure_deficit_Pa[i]*
+                       pf->wind_speed_m_per_s[i]/
+                       (pf->air_pressure_Pa[i]*params->aerodynamic_log_squared[i]);
+    double aerodynamic_rate = mass_flux/iv->liquid_water_density_kg_per_m3[i];
+
+    if (use_combination)
+    {
+      double delta = iv->slope_sat_vap_press_curve_Pa_s[i];
+      double gamma = iv->psychrometric_constant_Pa_per_C[i];
+      double radiation_rate = pf->net_radiation_W_per_sq_m[i]/
+                              (iv->liquid_water_density_kg_per_m3[i]*iv->water_latent_heat_of_vaporization_J_per_kg[i]);
+      batch->pet_m_per_s[i] = delta/(delta+gamma)*radiation_rate + gamma/(delta+gamma)*aerodynamic_rate;
+    }
+    else
+      batch->pet_m_per_s[i] = aerodynamic_rate;
+  }
+}
+
+// see pevapotranspiration_priestley_taylor_method()
+static void pet_batch_priestley_taylor_method(pet_batch *batch)
+{
+  long n = batch->n_catchments;
+  const struct pet_batch_inter_vars *iv = &batch->inter_vars;
+
+  pet_batch_intermediate_variables(batch);
+
+  for (long i = 0; i < n; i++)
+  {
+    double delta = iv->slope_sat_vap_press_curve_Pa_s[i];
+    double gamma = iv->psychrometric_constant_Pa_per_C[i];
+    double radiation_rate = batch->pet_forcing.net_radiation_W_per_sq_m[i]/
+                            (iv->liquid_water_density_kg_per_m3[i]*iv->water_latent_heat_of_vaporization_J_per_kg[i]);
+    batch->pet_m_per_s[i] = 1.3*delta/(delta+gamma)*radiation_rate;
+  }
+}
+
+// see pevapotranspiration_penman_monteith_method(), penman_monteith_pet_calculation() and
+// calculate_aerodynamic_resistance()
+static void pet_batch_penman_monteith_method(pet_batch *batch)
+{
+  long n = batch->n_catchments;
+  const struct pet_batch_params *params = &batch->pet_params;
+  const struct pet_batch_pet_forcing *pf = &batch->pet_forcing;
+  const struct pet_batch_inter_vars *iv = &batch->inter_vars;
+
+  pet_batch_intermediate_variables(batch);
+
+  for (long i = 0; i < n; i++)
+  {
+    double delta = iv->slope_sat_vap_press_curve_Pa_s[i];
+    double gamma = iv->psychrometric_constant_Pa_per_C[i];
+    double ra = params->aerodynamic_resistance_log_product[i]/(KV2*pf->wind_speed_m_per_s[i]);
+    double pm_numerator, pm_denominator;
+
+    pm_numerator   = delta*(pf->net_radiation_W_per_sq_m[i] - pf->ground_heat_flux_W_per_sq_m[i]) +
+                     iv->moist_air_density_kg_per_m3[i]*CP*iv->vapor_pressure_deficit_Pa[i]/ra;
+    pm_denominator = delta + gamma*(1.0+pf->canopy_resistance_sec_per_m[i]/ra);
+
+    batch->pet_m_per_s[i] = (pm_numerator/pm_denominator)/
+                            (iv->liquid_water_density_kg_per_m3[i]*iv->water_latent_heat_of_vaporization_J_per_kg[i]);
+  }
+}
+
+//#####################################################################################################################
+
+extern int pet_batch_init(pet_batch *batch, long n_catchments, int pet_method)
+{
+  double *storage;
+
+  memset(batch, 0, sizeof(pet_batch));
+  if (n_catchments < 1 || pet_method < 1 || pet_method > 5)
+    return -1;
+
+  storage = (double *) calloc((size_t)PET_BATCH_ARRAY_COUNT*n_catchments, sizeof(double));
+  if (storage == NULL) {
+    printf("Problem allocating memory for %ld catchments in pet_batch_init\n", n_catchments);
+    return -1;
+  }
+  return pet_batch_init_storage(batch, storage, n_catchments, pet_method);
+}
+
+extern int pet_batch_init_storage(pet_batch *batch, double *storage, long n_catchments, int pet_method)
+{
+  double *next;
+
+  memset(batch, 0, sizeof(pet_batch));
+  if (storage == NULL || n_catchments < 1 || pet_method < 1 || pet_method > 5)
+    return -1;
+
+  batch->storage      = storage;
+  batch->n_catchments = n_catchments;
+  batch->pet_method   = pet_method;
+
+  // every array is contiguous over catchments, and the arrays follow each other in one block
+  next = batch->storage;
+#define PET_BATCH_CARVE(field) do { (field) = next; next += n_catchments; } while (0)
+  PET_BATCH_CARVE(batch->pet_params.wind_speed_height_scale);
+  PET_BATCH_CARVE(batch->pet_params.heat_transfer_roughness_length_m);
+  PET_BATCH_CARVE(batch->pet_params.aerodynamic_log_squared);
+  PET_BATCH_CARVE(batch->pet_params.aerodynamic_resistance_log_product);
+  PET_BATCH_CARVE(batch->pet_params.surface_longwave_emissivity);
+  PET_BATCH_CARVE(batch->pet_params.surface_shortwave_albedo);
+
+  PET_BATCH_CARVE(batch->forcing.incoming_longwave_W_per_m2);
+  PET_BATCH_CARVE(batch->forcing.incoming_shortwave_W_per_m2);
+  PET_BATCH_CARVE(batch->forcing.surface_pressure_Pa);
+  PET_BATCH_CARVE(batch->forcing.specific_humidity_2m_kg_per_kg);
+  PET_BATCH_CARVE(batch->forcing.air_temperature_2m_K);
+  PET_BATCH_CARVE(batch->forcing.u_wind_speed_10m_m_per_s);
+  PET_BATCH_CARVE(batch->forcing.v_wind_speed_10m_m_per_s);
+
+  PET_BATCH_CARVE(batch->pet_forcing.net_radiation_W_per_sq_m);
+  PET_BATCH_CARVE(batch->pet_forcing.air_temperature_C);
+  PET_BATCH_CARVE(batch->pet_forcing.specific_humidity_2m_kg_per_kg);
+  PET_BATCH_CARVE(batch->pet_forcing.air_pressure_Pa);
+  PET_BATCH_CARVE(batch->pet_forcing.wind_speed_m_per_s);
+  PET_BATCH_CARVE(batch->pet_forcing.canopy_resistance_sec_per_m);
+  PET_BATCH_CARVE(batch->pet_forcing.water_temperature_C);
+  PET_BATCH_CARVE(batch->pet_forcing.ground_heat_flux_W_per_sq_m);
+
+  PET_BATCH_CARVE(batch->surf_rad_forcing.incoming_shortwave_radiation_W_per_sq_m);
+  PET_BATCH_CARVE(batch->surf_rad_forcing.incoming_longwave_radiation_W_per_sq_m);
+  PET_BATCH_CARVE(batch->surf_rad_forcing.air_temperature_C);
+  PET_BATCH_CARVE(batch->surf_rad_forcing.relative_humidity_percent);
+  PET_BATCH_CARVE(batch->surf_rad_forcing.surface_skin_temperature_C);
+
+  PET_BATCH_CARVE(batch->inter_vars.liquid_water_density_kg_per_m3);
+  PET_BATCH_CARVE(batch->inter_vars.water_latent_heat_of_vaporization_J_per_kg);
+  PET_BATCH_CARVE(batch->inter_vars.air_saturation_vapor_pressure_Pa);
+  PET_BATCH_CARVE(batch->inter_vars.air_actual_vapor_pressure_Pa);
+  PET_BATCH_CARVE(batch->inter_vars.vapor_pressure_deficit_Pa);
+  PET_BATCH_CARVE(batch->inter_vars.moist_air_gas_constant_J_per_kg_K);
+  PET_BATCH_CARVE(batch->inter_vars.moist_air_density_kg_per_m3);
+  PET_BATCH_CARVE(batch->inter_vars.slope_sat_vap_press_curve_Pa_s);
+  PET_BATCH_CARVE(batch->inter_vars.psychrometric_constant_Pa_per_C);
+
+  PET_BATCH_CARVE(batch->pet_m_per_s);
+
+  PET_BATCH_CARVE(batch->aggregates.daily_m);
+  PET_BATCH_CARVE(batch->aggregates.monthly_m);
+  PET_BATCH_CARVE(batch->aggregates.cumulative_m);
+  PET_BATCH_CARVE(batch->aggregates.day_m);
+  PET_BATCH_CARVE(batch->aggregates.day_compensation_m);
+  PET_BATCH_CARVE(batch->aggregates.month_m);
+  PET_BATCH_CARVE(batch->aggregates.month_compensation_m);
+  PET_BATCH_CARVE(batch->aggregates.cumulative_compensation_m);
+#undef PET_BATCH_CARVE
+
+  return 0;
+}
+
+extern int pet_batch_set_catchment(pet_batch *batch, long i, const pet_model *model)
+{
+  if (i < 0 || i >= batch->n_catchments)
+    return -1;
+  if (model->pet_options.yes_aorc != 1 || model->pet_method != batch->pet_method) {
+    printf("pet_batch_set_catchment: catchment %ld must use AORC forcing and PET method %d\n", i, batch->pet_method);
+    return -1;
+  }
+
+  batch->pet_params.wind_speed_height_scale[i]            = model->derived_params.wind_speed_height_scale;
+  batch->pet_params.heat_transfer_roughness_length_m[i]   = model->derived_params.heat_transfer_roughness_length_m;
+  batch->pet_params.aerodynamic_log_squared[i]            = model->derived_params.aerodynamic_log_squared;
+  batch->pet_params.aerodynamic_resistance_log_product[i] = model->derived_params.aerodynamic_resistance_log_product;
+  batch->pet_params.surface_longwave_emissivity[i]        = model->surf_rad_params.surface_longwave_emissivity;
+  batch->pet_params.surface_shortwave_albedo[i]           = model->surf_rad_params.surface_shortwave_albedo;
+
+  batch->pet_forcing.canopy_resistance_sec_per_m[i]  = model->pet_forcing.canopy_resistance_sec_per_m;
+  batch->pet_forcing.water_temperature_C[i]          = model->pet_forcing.water_temperature_C;
+  batch->pet_forcing.ground_heat_flux_W_per_sq_m[i]  = model->pet_forcing.ground_heat_flux_W_per_sq_m;
+  batch->surf_rad_forcing.surface_skin_temperature_C[i] = model->surf_rad_forcing.surface_skin_temperature_C;
+
+  return 0;
+}
+
+extern int pet_batch_run(pet_batch *batch)
+{
+  long n = batch->n_catchments;
+
+  pet_batch_stage_forcing(batch);
+
+  // we must calculate the net radiation before calling the ET subroutine, except for the aerodynamic method.
+  if (batch->pet_method != 2)
+    pet_batch_net_radiation(batch);
+
+  switch (batch->pet_method)
+  {
+    case 1: pet_batch_energy_balance_method(batch);                 break;
+    case 2: pet_batch_aerodynamic_and_combination_method(batch, 0); break;
+    case 3: pet_batch_aerodynamic_and_combination_method(batch, 1); break;
+    case 4: pet_batch_priestley_taylor_method(batch);               break;
+    case 5: pet_batch_penman_monteith_method(batch);                break;
+    default: return -1;
+  }
+
+  // prevent dew from forming (i.e., PET < 0)
+  for (long i = 0; i < n; i++)
+    if (batch->pet_m_per_s[i] < 0) batch->pet_m_per_s[i] = 0;
+
+  return 0;
+}
+
+extern void pet_batch_aggregate(pet_batch *batch, double step_time_s, double time_step_size_s)
+{
+  struct pet_batch_aggregates *sums = &batch->aggregates;
+  struct pet_aggregates one;
+  int ends_day, ends_month;
+
+  pet_step_ends_period(step_time_s, time_step_size_s, &ends_day, &ends_month);
+  for (long i = 0; i < batch->n_catchments; i++) {
+    one.daily_m = sums->daily_m[i];
+    one.monthly_m = sums->monthly_m[i];
+    one.cumulative_m = sums->cumulative_m[i];
+    one.day_m = sums->day_m[i];
+    one.day_compensation_m = sums->day_compensation_m[i];
+    one.month_m = sums->month_m[i];
+    one.month_compensation_m = sums->month_compensation_m[i];
+    one.cumulative_compensation_m = sums->cumulative_compensation_m[i];
+
+    accumulate_pet_depth(&one, batch->pet_m_per_s[i] * time_step_size_s, ends_day, ends_month);
+
+    sums->daily_m[i] = one.daily_m;
+    sums->monthly_m[i] = one.monthly_m;
+    sums->cumulative_m[i] = one.cumulative_m;
+    sums->day_m[i] = one.day_m;
+    sums->day_compensation_m[i] = one.day_compensation_m;
+    sums->month_m[i] = one.month_m;
+    sums->month_compensation_m[i] = one.month_compensation_m;
+    sums->cumulative_compensation_m[i] = one.cumulative_compensation_m;
+  }
+}
+
+extern void pet_batch_free(pet_batch *batch)
+{
+  free(batch->storage);
+  memset(batch, 0, sizeof(pet_batch));
+}
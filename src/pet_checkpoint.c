@@ -0,0 +1,266 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../include/pet.h"
+#include "../include/pet_batch.h"
+#include "../include/pet_forcing.h"
+#include "../include/pet_checkpoint.h"
+
+#define PET_CHECKPOINT_BYTE_ORDER 0x01020304u
+
+// the scalars of the dynamic state, saved as one record
+struct pet_checkpoint_scalars {
+  double   current_time_step;
+  int64_t  current_step;
+  double   current_time;
+  double   pet_m_per_s;
+  uint32_t warnings_issued;
+};
+
+// the sections of the payload, in order; struct_bytes of the header holds their sizes
+enum {
+  SECTION_SCALARS,
+  SECTION_AORC,
+  SECTION_PET_FORCING,
+  SECTION_INTER_VARS,
+  SECTION_SURF_RAD_FORCING,
+  SECTION_SOLAR_RESULTS,
+  SECTION_AGGREGATES,
+  SECTION_TIMING,
+  N_SECTIONS
+};
+
+static const uint32_t section_bytes[N_SECTIONS] = {
+  sizeof(struct pet_checkpoint_scalars),
+  sizeof(struct aorc_forcing_data_pet),
+  sizeof(struct pevapotranspiration_forcing),
+  sizeof(struct intermediate_vars),
+  sizeof(struct surface_radiation_forcing),
+  sizeof(struct solar_radiation_results),
+  sizeof(struct pet_aggregates),
+  sizeof(struct pet_timing)
+};
+
+static size_t batch_bytes(const pet_model *model)
+{
+  if (model->vector_batch == NULL)
+    return 0;
+  return (size_t)PET_BATCH_ARRAY_COUNT * (size_t)model->vector_batch->n_catchments * sizeof(double);
+}
+
+static size_t payload_bytes(const pet_model *model)
+{
+  size_t bytes = batch_bytes(model);
+  int s;
+
+  for (s = 0; s < N_SECTIONS; s++)
+    bytes += section_bytes[s];
+  return bytes;
+}
+
+// FNV-1a
+static uint64_t checksum(const unsigned char *data, size_t n)
+{
+  uint64_t hash = 14695981039346656037ull;
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    hash ^= data[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+static void fill_header(const pet_model *model, pet_checkpoint_header *header)
+{
+  memset(header, 0, sizeof(*header));
+  memcpy(header->magic, PET_CHECKPOINT_MAGIC, sizeof(PET_CHECKPOINT_MAGIC));
+  header->version = PET_CHECKPOINT_VERSION;
+  header->byte_order = PET_CHECKPOINT_BYTE_ORDER;
+  memcpy(header->struct_bytes, section_bytes, sizeof(section_bytes));
+  header->pet_method = model->pet_method;
+  header->time_step_size_s = model->bmi.time_step_size_s;
+  header->n_catchments = (model->vector_batch != NULL) ? model->vector_batch->n_catchments : 0;
+  header->payload_bytes = payload_bytes(model);
+}
+
+// copy n bytes to *p, or from *p, and move *p past them
+static void put(unsigned char **p, const void *from, size_t n)
+{
+  memcpy(*p, from, n);
+  *p += n;
+}
+
+static void get(const unsigned char **p, void *to, size_t n)
+{
+  memcpy(to, *p, n);
+  *p += n;
+}
+
+//#####################################################################################################################
+
+extern size_t pet_checkpoint_size(const pet_model *model)
+{
+  return sizeof(pet_checkpoint_header) + payload_bytes(model);
+}
+
+extern size_t pet_checkpoint_save(const pet_model *model, void *buffer, size_t buffer_bytes)
+{
+  pet_checkpoint_header header;
+  struct pet_checkpoint_scalars scalars;
+  unsigned char *payload = (unsigned char *)buffer + sizeof(header);
+  unsigned char *p = payload;
+  size_t size = pet_checkpoint_size(model);
+
+  if (buffer_bytes < size) {
+    printf("A checkpoint of this PET instance takes %zu bytes, the buffer has %zu\n", size, buffer_bytes);
+    return 0;
+  }
+
+  memset(&scalars, 0, sizeof(scalars));
+  scalars.current_time_step = model->bmi.current_time_step;
+  scalars.current_step      = model->bmi.current_step;
+  scalars.current_time      = model->bmi.current_time;
+  scalars.pet_m_per_s       = model->pet_m_per_s;
+  scalars.warnings_issued   = model->warnings_issued;
+
+  put(&p, &scalars, sizeof(scalars));
+  put(&p, &model->aorc, sizeof(model->aorc));
+  put(&p, &model->pet_forcing, sizeof(model->pet_forcing));
+  put(&p, &model->inter_vars, sizeof(model->inter_vars));
+  put(&p, &model->surf_rad_forcing, sizeof(model->surf_rad_forcing));
+  put(&p, &model->solar_results, sizeof(model->solar_results));
+  put(&p, &model->aggregates, sizeof(model->aggregates));
+  put(&p, &model->timing, sizeof(model->timing));
+  if (model->vector_batch != NULL)
+    put(&p, model->vector_batch->storage, batch_bytes(model));
+
+  fill_header(model, &header);
+  header.payload_checksum = checksum(payload, (size_t)(p - payload));
+  memcpy(buffer, &header, sizeof(header));
+  return size;
+}
+
+extern int pet_checkpoint_restore(pet_model *model, const void *buffer, size_t buffer_bytes)
+{
+  pet_checkpoint_header header, expected;
+  struct pet_checkpoint_scalars scalars;
+  const unsigned char *payload = (const unsigned char *)buffer + sizeof(header);
+  const unsigned char *p = payload;
+
+  if (buffer_bytes < sizeof(header)) {
+    printf("PET checkpoint of %zu bytes is too short\n", buffer_bytes);
+    return -1;
+  }
+  memcpy(&header, buffer, sizeof(header));
+  fill_header(model, &expected);
+
+  if (memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version ||
+      header.byte_order != expected.byte_order ||
+      memcmp(header.struct_bytes, expected.struct_bytes, sizeof(header.struct_bytes)) != 0) {
+    printf("Not a PET checkpoint of version %d written on a machine like this one\n", PET_CHECKPOINT_VERSION);
+    return -1;
+  }
+  if (header.pet_method != expected.pet_method || header.time_step_size_s != expected.time_step_size_s ||
+      header.n_catchments != expected.n_catchments) {
+    printf("PET checkpoint of pet method %d, time step %d s and %ld catchments does not fit an instance of pet "
+           "method %d, time step %d s and %ld catchments\n", (int)header.pet_method, (int)header.time_step_size_s,
+           (long)header.n_catchments, (int)expected.pet_method, (int)expected.time_step_size_s,
+           (long)expected.n_catchments);
+    return -1;
+  }
+  if (header.payload_bytes != expected.payload_bytes || buffer_bytes < sizeof(header) + header.payload_bytes ||
+      checksum(payload, (size_t)header.payload_bytes) != header.payload_checksum) {
+    printf("PET checkpoint is truncated or damaged\n");
+    return -1;
+  }
+
+  get(&p, &scalars, sizeof(scalars));
+  if (model->bmi.is_forcing_from_bmi == 0 &&
+      (scalars.current_step < 0 || scalars.current_step > model->bmi.num_timesteps)) {
+    printf("PET checkpoint is at step %ld, the forcing of this instance has %ld\n",
+           (long)scalars.current_step, model->bmi.num_timesteps);
+    return -1;
+  }
+
+  model->bmi.current_time_step = scalars.current_time_step;
+  model->bmi.current_step      = (long)scalars.current_step;
+  model->bmi.current_time      = scalars.current_time;
+  model->pet_m_per_s           = scalars.pet_m_per_s;
+  model->warnings_issued       = scalars.warnings_issued;
+
+  get(&p, &model->aorc, sizeof(model->aorc));
+  get(&p, &model->pet_forcing, sizeof(model->pet_forcing));
+  get(&p, &model->inter_vars, sizeof(model->inter_vars));
+  get(&p, &model->surf_rad_forcing, sizeof(model->surf_rad_forcing));
+  get(&p, &model->solar_results, sizeof(model->solar_results));
+  get(&p, &model->aggregates, sizeof(model->aggregates));
+  get(&p, &model->timing, sizeof(model->timing));
+  if (model->vector_batch != NULL)
+    get(&p, model->vector_batch->storage, batch_bytes(model));
+
+  // the window of a streamed forcing file moves to the restored step now, so a file that cannot be read shows here
+  if (model->forcing_stream != NULL && model->bmi.current_step < model->bmi.num_timesteps) {
+    long row = model->bmi.current_step - model->forcing_block.first_row;
+    if ((row < 0 || row >= model->forcing_block.n_rows) &&
+        advance_forcing_window_pet(model, model->bmi.current_step) < 0)
+      return -1;
+  }
+  return 0;
+}
+
+extern int pet_checkpoint_save_file(const pet_model *model, const char *file_name)
+{
+  size_t size = pet_checkpoint_size(model);
+  void *buffer = malloc(size);
+  FILE *fp;
+  int status = -1;
+
+  if (buffer == NULL) {
+    printf("Problem allocating %zu bytes for the PET checkpoint '%s'\n", size, file_name);
+    return -1;
+  }
+  pet_checkpoint_save(model, buffer, size);
+  if ((fp = fopen(file_name, "wb")) == NULL)
+    printf("PET checkpoint file '%s' could not be opened for writing\n", file_name);
+  else {
+    if ((fwrite(buffer, 1, size, fp) != size) | (fclose(fp) != 0))  // both, so that the file is always closed
+      printf("PET checkpoint file '%s' could not be written\n", file_name);
+    else
+      status = 0;
+  }
+  free(buffer);
+  return status;
+}
+
+extern int pet_checkpoint_restore_file(pet_model *model, const char *file_name)
+{
+  size_t size = pet_checkpoint_size(model), n_read;
+  void *buffer;
+  FILE *fp;
+  int status;
+
+  if ((fp = fopen(file_name, "rb")) == NULL) {
+    printf("PET checkpoint file '%s' could not be opened for reading\n", file_name);
+    return -1;
+  }
+  // one byte more than a checkpoint of this model takes, so that a longer file is not taken for one
+  if ((buffer = malloc(size + 1)) == NULL) {
+    printf("Problem allocating %zu bytes for the PET checkpoint '%s'\n", size, file_name);
+    fclose(fp);
+    return -1;
+  }
+  n_read = fread(buffer, 1, size + 1, fp);
+  fclose(fp);
+  if (n_read != size) {
+    printf("PET checkpoint file '%s' has %s bytes than a checkpoint of this instance\n", file_name,
+           n_read < size ? "fewer" : "more");
+    status = -1;
+  }
+  else
+    status = pet_checkpoint_restore(model, buffer, size);
+  free(buffer);
+  return status;
+}
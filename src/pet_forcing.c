@@ -0,0 +1,907 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(PET_FORCING_PREFETCH)
+#include <pthread.h>
+#endif
+
+#include "../include/pet.h"
+#include "../include/pet_forcing.h"
+#include "../include/pet_arena.h"
+#include "../include/pet_log.h"
+
+// the last line is copied here if the file does not end with a newline, so that strtof() cannot run off the mapping
+#define PET_FORCING_MAX_LAST_LINE 1024
+
+// longest csv line the streaming reader takes, longer lines are cut
+#define PET_FORCING_MAX_STREAM_LINE 4096
+
+// window of a streamed file when forcing_prefetch is set without forcing_window_steps: 30 days of hourly forcing
+#define PET_FORCING_DEFAULT_WINDOW_STEPS 720
+
+struct pet_forcing_stream {
+  FILE   *fp;
+  int     is_binary;
+  struct pet_forcing_bin_header header;     // of a binary file
+  double  time_step_size_s;                 // of the model, the precip column is scaled by it
+  long    data_start;                       // file offset of the first data row of a csv
+  long    next_file_row;                    // the csv row the file position is at
+  long    n_file_rows;                      // data rows in the file
+  double  last_row[PET_FORCING_N_COLUMNS];  // repeated for the timesteps past the end of the file
+  char    line[PET_FORCING_MAX_STREAM_LINE];
+#if defined(PET_FORCING_PREFETCH)
+  // Helper thread filling the spare block with the window after the current one.  Everything above, and the spare
+  // block, belong to the helper while busy or request_step >= 0, and to the thread running the model otherwise.
+  int             prefetching;      // the helper thread was started
+  pthread_t       thread;
+  pthread_mutex_t lock;
+  pthread_cond_t  wake;             // request_step was set, or quit
+  pthread_cond_t  done;             // the helper finished a window
+  int             quit;
+  int             busy;
+  long            request_step;     // first timestep of the window to read next, -1 for none
+  struct pet_forcing_block spare;   // first_row is the timestep it holds, -1 if it holds nothing usable
+#endif
+};
+
+//#####################################################################################################################
+// Map a whole file copy-on-write, so that a binary file's precip column can be rescaled in place without touching
+// the file.  Returns NULL if it cannot be opened or is empty.  Where mmap is not available the file is read into a
+// heap buffer instead.
+//#####################################################################################################################
+static char *map_forcing_file_pet(const char *file_name, size_t *size)
+{
+#if defined(_WIN32)
+  FILE *fp = fopen(file_name, "rb");
+  char *data;
+  long length;
+
+  if (fp == NULL)
+    return NULL;
+  fseek(fp, 0, SEEK_END);
+  length = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  if (length <= 0 || (data = malloc((size_t)length)) == NULL) {
+    fclose(fp);
+    return NULL;
+  }
+  *size = fread(data, 1, (size_t)length, fp);
+  fclose(fp);
+  return data;
+#else
+  struct stat st;
+  void *data;
+  int fd = open(file_name, O_RDONLY);
+
+  if (fd == -1)
+    return NULL;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return NULL;
+  }
+  data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);  // the mapping stays valid after the descriptor is closed
+  if (data == MAP_FAILED)
+    return NULL;
+#if defined(MADV_SEQUENTIAL)
+  madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+  *size = (size_t)st.st_size;
+  return (char *)data;
+#endif
+}
+
+static void unmap_forcing_file_pet(void *data, size_t size)
+{
+#if defined(_WIN32)
+  free(data);
+#else
+  munmap(data, size);
+#endif
+}
+
+// address of the forcing_data_* array holding a column of the binary format
+static double **forcing_column_pet(pet_model* model, int column)
+{
+  switch (column)
+  {
+    case PET_FORCING_TIME:               return &model->forcing_data_time;
+    case PET_FORCING_PRECIP:             return &model->forcing_data_precip_kg_per_m2;
+    case PET_FORCING_INCOMING_LONGWAVE:  return &model->forcing_data_incoming_longwave_W_per_m2;
+    case PET_FORCING_INCOMING_SHORTWAVE: return &model->forcing_data_incoming_shortwave_W_per_m2;
+    case PET_FORCING_SURFACE_PRESSURE:   return &model->forcing_data_surface_pressure_Pa;
+    case PET_FORCING_SPECIFIC_HUMIDITY:  return &model->forcing_data_specific_humidity_2m_kg_per_kg;
+    case PET_FORCING_AIR_TEMPERATURE:    return &model->forcing_data_air_temperature_2m_K;
+    case PET_FORCING_U_WIND_SPEED:       return &model->forcing_data_u_wind_speed_10m_m_per_s;
+    default:                             return &model->forcing_data_v_wind_speed_10m_m_per_s;
+  }
+}
+
+// columns of n rows and at least one spare, rounded up to 64 bytes, at the given stride from base
+static void point_forcing_arrays_pet(pet_model* model, double *base, long n, long column_stride)
+{
+  int c;
+
+  model->forcing_block.base = base;
+  model->forcing_block.first_row = 0;
+  model->forcing_block.n_rows = n;
+  model->forcing_block.column_stride = column_stride;
+  for (c = 0; c < PET_FORCING_N_COLUMNS; c++)
+    *forcing_column_pet(model, c) = (base != NULL) ? base + c * column_stride : NULL;
+}
+
+// doubles per column of n rows, one more than needed as there always have been, to a multiple of 64 bytes.  The
+// binary format lays its columns out the same way.
+static long forcing_column_stride_pet(long n)
+{
+  const long doubles_per_line = PET_FORCING_BIN_ALIGNMENT / sizeof(double);
+  return (n + 1 + doubles_per_line - 1) / doubles_per_line * doubles_per_line;
+}
+
+// one zeroed, 64 byte aligned block in the arena of the model for all the columns of n rows.  Returns 0, or -1 (after
+// printing why).
+static int alloc_forcing_arrays_pet(pet_model* model, long n)
+{
+  long column_stride = forcing_column_stride_pet(n);
+  double *base = pet_model_alloc(model, sizeof(double) * column_stride * PET_FORCING_N_COLUMNS);
+
+  if (base == NULL) {
+    printf("Problem allocating memory for %ld rows of forcing\n", n);
+    return -1;
+  }
+  point_forcing_arrays_pet(model, base, n, column_stride);
+  return 0;
+}
+
+//#####################################################################################################################
+// Parse the value of the field starting at *s and move *s past the comma that ends it.  An empty field gives 0, as
+// strtof() on an empty string did in parse_aorc_line_pet().  Values go through float, as they always have.
+//#####################################################################################################################
+static double read_forcing_field_pet(const char **s, const char *line_end)
+{
+  const char *field = *s;
+  const char *comma = memchr(field, ',', (size_t)(line_end - field));
+  const char *field_end = (comma != NULL) ? comma : line_end;
+  char *next;
+  double value = (double)strtof(field, &next);
+
+  if (next > field_end)  // nothing in this field, strtof skipped the newline and read into the next line
+    value = 0.0;
+  *s = (comma != NULL) ? comma + 1 : line_end;
+  return value;
+}
+
+// the timestamp field, as seconds since 1970 UTC
+static double read_forcing_time_pet(const char **s, const char *line_end)
+{
+  const char *comma = memchr(*s, ',', (size_t)(line_end - *s));
+  double time = 0.0;
+
+  parse_timestamp_pet(*s, &time);
+  *s = (comma != NULL) ? comma + 1 : line_end;
+  return time;
+}
+
+//#####################################################################################################################
+// Timestamps.  Days from civil after H. Hinnant, "chrono-Compatible Low-Level Date Algorithms": the year is shifted to
+// start in March so the leap day comes last, then split into 400 year eras of 146097 days.
+//#####################################################################################################################
+static int64_t days_from_civil_pet(int64_t year, int64_t month, int64_t day)
+{
+  int64_t era, year_of_era, day_of_year, day_of_era;
+
+  year -= (month <= 2);
+  era = (year >= 0 ? year : year - 399) / 400;
+  year_of_era = year - era * 400;                                                  // [0, 399]
+  day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;    // [0, 365]
+  day_of_era  = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;  // [0, 146096]
+  return era * 146097 + day_of_era - 719468;                                       // 719468 days from 0000-03-01
+}
+
+extern int64_t civil_to_epoch_seconds_pet(long year, long month, long day, long hour, long minute, long second)
+{
+  return days_from_civil_pet(year, month, day) * 86400 + (int64_t)hour * 3600 + (int64_t)minute * 60 + second;
+}
+
+// the inverse of days_from_civil_pet(), same shifted year and eras
+extern void epoch_days_to_civil_pet(int64_t days, long *year, long *month, long *day)
+{
+  int64_t era, day_of_era, year_of_era, day_of_year, shifted_month;
+
+  days += 719468;
+  era = (days >= 0 ? days : days - 146096) / 146097;
+  day_of_era  = days - era * 146097;                                                           // [0, 146096]
+  year_of_era = (day_of_era - day_of_era/1460 + day_of_era/36524 - day_of_era/146096) / 365;   // [0, 399]
+  day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);        // [0, 365]
+  shifted_month = (5 * day_of_year + 2) / 153;                                                 // [0, 11] from March
+  *day   = (long)(day_of_year - (153 * shifted_month + 2) / 5 + 1);
+  *month = (long)(shifted_month < 10 ? shifted_month + 3 : shifted_month - 9);
+  *year  = (long)(year_of_era + era * 400 + (*month <= 2));
+}
+
+// digits at *s into *value, returns 0 if there are none
+static int read_digits_pet(const char **s, long *value)
+{
+  const char *p = *s;
+  long v = 0;
+
+  while (*p >= '0' && *p <= '9')
+    v = v * 10 + (*p++ - '0');
+  if (p == *s)
+    return 0;
+  *value = v;
+  *s = p;
+  return 1;
+}
+
+// the date part, YYYY-MM-DD, as a day number
+static const char *parse_date_pet(const char *s, int64_t *days)
+{
+  long year, month, day;
+
+  while (*s == ' ' || *s == '\t')
+    s++;
+  if (!read_digits_pet(&s, &year) || *s++ != '-' || !read_digits_pet(&s, &month) || *s++ != '-' ||
+      !read_digits_pet(&s, &day) || month < 1 || month > 12 || day < 1 || day > 31)
+    return NULL;
+  *days = days_from_civil_pet(year, month, day);
+  return s;
+}
+
+// the time part, " hh:mm:ss", which may be missing or stop after the minutes
+static const char *parse_time_of_day_pet(const char *s, long *seconds)
+{
+  long hour = 0, minute = 0, second = 0;
+  const char *p = s;
+
+  if (*p == ' ' || *p == 'T') {
+    p++;
+    if (read_digits_pet(&p, &hour) && *p == ':') {
+      p++;
+      if (read_digits_pet(&p, &minute) && *p == ':') {
+        p++;
+        read_digits_pet(&p, &second);
+      }
+      s = p;
+    }
+  }
+  *seconds = hour * 3600 + minute * 60 + second;
+  return s;
+}
+
+extern const char *parse_timestamp_pet(const char *s, double *epoch_seconds)
+{
+  int64_t days;
+  long seconds;
+
+  s = parse_date_pet(s, &days);
+  if (s == NULL)
+    return NULL;
+  s = parse_time_of_day_pet(s, &seconds);
+  *epoch_seconds = (double)(days * 86400 + seconds);
+  return s;
+}
+
+extern long parse_timestamp_column_pet(const char *const *timestamps, long n, double *epoch_seconds)
+{
+  const char *date = NULL;  // date part of the last timestamp parsed
+  int64_t days = 0;
+  long i, seconds, n_failed = 0;
+
+  for (i = 0; i < n; i++) {
+    const char *s = timestamps[i];
+
+    // "YYYY-MM-DD" the same as the row before: only the time of day needs parsing
+    if (date != NULL && strncmp(s, date, 10) == 0)
+      s += 10;
+    else if ((s = parse_date_pet(timestamps[i], &days)) != NULL && s - timestamps[i] == 10)
+      date = timestamps[i];
+    else
+      date = NULL;
+
+    if (s == NULL) {
+      epoch_seconds[i] = 0.0;
+      n_failed++;
+      continue;
+    }
+    parse_time_of_day_pet(s, &seconds);
+    epoch_seconds[i] = (double)(days * 86400 + seconds);
+  }
+  return n_failed;
+}
+
+// one data line into row i of a forcing block, the csv columns after the time are in the order of the block
+static void parse_forcing_record_to_block_pet(const struct pet_forcing_block *block, double time_step_size_s, long i,
+                                              const char *s, const char *line_end)
+{
+  double *row = block->base + i;
+  long stride = block->column_stride;
+  int c;
+
+  row[PET_FORCING_TIME * stride] = read_forcing_time_pet(&s, line_end);
+  read_forcing_field_pet(&s, line_end);  // APCP_surface, the precip_rate column is used instead
+  for (c = PET_FORCING_INCOMING_LONGWAVE; c < PET_FORCING_N_COLUMNS; c++)
+    row[c * stride] = read_forcing_field_pet(&s, line_end);
+  row[PET_FORCING_PRECIP * stride] = read_forcing_field_pet(&s, line_end) * time_step_size_s;
+}
+
+// one data line into row i of the forcing arrays
+static void parse_forcing_record_pet(pet_model* model, long i, const char *s, const char *line_end)
+{
+  parse_forcing_record_to_block_pet(&model->forcing_block, (double)model->bmi.time_step_size_s, i, s, line_end);
+}
+
+static void copy_forcing_row_pet(pet_model* model, long to, long from)
+{
+  int c;
+  for (c = 0; c < PET_FORCING_N_COLUMNS; c++) {
+    double *column = *forcing_column_pet(model, c);
+    column[to] = column[from];
+  }
+}
+
+// the csv reader, returns the number of rows read or -1 if the arrays could not be allocated
+static long read_forcing_csv_pet(pet_model* model, const char *data, size_t size)
+{
+  const char *end = data + size;
+  const char *p, *line_end;
+  char last_line[PET_FORCING_MAX_LAST_LINE];
+  long n_rows = 0;
+
+  // skip the header line
+  p = memchr(data, '\n', size);
+  p = (p != NULL) ? p + 1 : end;
+
+  if (model->bmi.num_timesteps <= 0) {
+    // take every row in the file, count them first
+    const char *q = p;
+    while (q < end && *q != '\n' && *q != '\r') {
+      q = memchr(q, '\n', (size_t)(end - q));
+      model->bmi.num_timesteps++;
+      q = (q != NULL) ? q + 1 : end;
+    }
+  }
+  if (alloc_forcing_arrays_pet(model, model->bmi.num_timesteps) != 0)
+    return -1;
+
+  while (n_rows < model->bmi.num_timesteps && p < end) {
+    line_end = memchr(p, '\n', (size_t)(end - p));
+    if (line_end == NULL) {
+      // last line without a newline, parse a terminated copy of it
+      size_t length = (size_t)(end - p);
+      if (length > PET_FORCING_MAX_LAST_LINE - 1)
+        length = PET_FORCING_MAX_LAST_LINE - 1;
+      memcpy(last_line, p, length);
+      last_line[length] = '\0';
+      parse_forcing_record_pet(model, n_rows++, last_line, last_line + length);
+      break;
+    }
+    if (line_end == p || (line_end == p + 1 && *p == '\r'))  // blank line, treat as the end of the data
+      break;
+    parse_forcing_record_pet(model, n_rows++, p, line_end);
+    p = line_end + 1;
+  }
+  return n_rows;
+}
+
+// the binary reader, returns the number of rows in the file, -1 if it is not a valid binary forcing file or -2 if the
+// arrays could not be allocated.  When the file covers num_timesteps the arrays are left pointing into the mapping and
+// *keep_mapping is set.
+static long read_forcing_binary_pet(pet_model* model, char *data, size_t size, int *keep_mapping)
+{
+  const struct pet_forcing_bin_header *header = (const struct pet_forcing_bin_header *)data;
+  double time_step_size_s = (double)model->bmi.time_step_size_s;
+  int64_t column_stride;
+  long n_rows, i;
+  int c, evenly_spaced;
+
+  if (size < sizeof(struct pet_forcing_bin_header) || header->version != PET_FORCING_BIN_VERSION ||
+      header->n_columns != PET_FORCING_N_COLUMNS || header->n_rows < 0)
+    return -1;
+  n_rows = (long)header->n_rows;
+  for (c = 0; c < PET_FORCING_N_COLUMNS; c++) {
+    if (header->column_offset[c] % PET_FORCING_BIN_ALIGNMENT != 0 ||
+        header->column_offset[c] < (int64_t)sizeof(struct pet_forcing_bin_header) ||
+        (uint64_t)header->column_offset[c] + (uint64_t)n_rows * sizeof(double) > size)
+      return -1;
+  }
+
+  if (model->bmi.num_timesteps <= 0)
+    model->bmi.num_timesteps = n_rows;
+
+  // the mapping can be used as the forcing block if the columns are evenly spaced, as pet_convert_forcing writes them,
+  // and the file holds the whole block, the spare rows after the last column included
+  column_stride = (header->column_offset[1] - header->column_offset[0]) / (int64_t)sizeof(double);
+  evenly_spaced = column_stride > n_rows &&
+                  (uint64_t)header->column_offset[0] +
+                  (uint64_t)column_stride * PET_FORCING_N_COLUMNS * sizeof(double) <= size;
+  for (c = 1; c < PET_FORCING_N_COLUMNS; c++)
+    evenly_spaced &= header->column_offset[c] == header->column_offset[0] + c * column_stride * (int64_t)sizeof(double);
+
+  if (n_rows >= model->bmi.num_timesteps && evenly_spaced) {
+    point_forcing_arrays_pet(model, (double *)(data + header->column_offset[0]), n_rows, (long)column_stride);
+    *keep_mapping = 1;
+  }
+  else {
+    if (alloc_forcing_arrays_pet(model, (n_rows > model->bmi.num_timesteps) ? n_rows : model->bmi.num_timesteps) != 0)
+      return -2;
+    for (c = 0; c < PET_FORCING_N_COLUMNS; c++)
+      memcpy(*forcing_column_pet(model, c), data + header->column_offset[c], n_rows * sizeof(double));
+    *keep_mapping = 0;
+  }
+
+  // The precip column is per time step of the file.  If the config asks for a different step, get back to the float
+  // precip_rate the csv held (exact, the product lost less than a float ulp) and scale as the csv reader would.
+  // With a mapped file this writes to private copies of the precip pages only.
+  if (header->time_step_size_s != time_step_size_s) {
+    double *precip = model->forcing_data_precip_kg_per_m2;
+    for (i = 0; i < n_rows && i < model->bmi.num_timesteps; i++)
+      precip[i] = (double)(float)(precip[i] / header->time_step_size_s) * time_step_size_s;
+  }
+  return n_rows;
+}
+
+//#####################################################################################################################
+// Streaming reader, for forcing_window_steps > 0.  The file is read with stdio through a fixed line buffer and the
+// forcing_data_* arrays hold forcing_window_steps consecutive rows starting at forcing_block.first_row, so the memory
+// of an instance does not depend on the length of the record.
+//#####################################################################################################################
+
+// the next csv line into stream->line, returns its length without the line ending, or -1 at the end of the data (end
+// of file or a blank line).  The rest of a line too long for the buffer is skipped.
+static long read_stream_line_pet(struct pet_forcing_stream *stream)
+{
+  long length;
+
+  if (fgets(stream->line, sizeof(stream->line), stream->fp) == NULL)
+    return -1;
+  length = (long)strlen(stream->line);
+  if (length > 0 && stream->line[length-1] != '\n' && !feof(stream->fp)) {
+    int ch;
+    while ((ch = fgetc(stream->fp)) != EOF && ch != '\n')
+      ;
+  }
+  while (length > 0 && (stream->line[length-1] == '\n' || stream->line[length-1] == '\r'))
+    stream->line[--length] = '\0';
+  if (length == 0)
+    return -1;
+  stream->next_file_row++;
+  return length;
+}
+
+// rows first_file_row .. first_file_row+n-1 of the file into rows 0 .. n-1 of a block.  Returns 0, or -1 if the
+// file could not be read.
+static int read_stream_rows_pet(struct pet_forcing_stream *stream, const struct pet_forcing_block *block,
+                                long first_file_row, long n)
+{
+  long i;
+  int c;
+
+  if (stream->is_binary) {
+    const struct pet_forcing_bin_header *header = &stream->header;
+    double *precip = block->base + PET_FORCING_PRECIP * block->column_stride;
+
+    for (c = 0; c < PET_FORCING_N_COLUMNS; c++)
+      if (fseek(stream->fp, (long)(header->column_offset[c] + first_file_row * (int64_t)sizeof(double)), SEEK_SET) != 0 ||
+          fread(block->base + c * block->column_stride, sizeof(double), (size_t)n, stream->fp) != (size_t)n)
+        return -1;
+    // as read_forcing_binary_pet() does for a different time step
+    if (header->time_step_size_s != stream->time_step_size_s)
+      for (i = 0; i < n; i++)
+        precip[i] = (double)(float)(precip[i] / header->time_step_size_s) * stream->time_step_size_s;
+    return 0;
+  }
+
+  // a csv can only be read forwards, go back to the first row if the run moved back
+  if (first_file_row < stream->next_file_row) {
+    if (fseek(stream->fp, stream->data_start, SEEK_SET) != 0)
+      return -1;
+    stream->next_file_row = 0;
+  }
+  while (stream->next_file_row < first_file_row)
+    if (read_stream_line_pet(stream) < 0)
+      return -1;
+  for (i = 0; i < n; i++) {
+    long length = read_stream_line_pet(stream);
+    if (length < 0)
+      return -1;
+    parse_forcing_record_to_block_pet(block, stream->time_step_size_s, i, stream->line, stream->line + length);
+  }
+  return 0;
+}
+
+// timesteps step .. step+n_rows-1 into a block of n_rows rows, a short file keeps its last row for the timesteps past
+// its end.  Returns 0, or -1 if the file could not be read.
+static int fill_stream_window_pet(struct pet_forcing_stream *stream, const struct pet_forcing_block *block, long step)
+{
+  long n_from_file = stream->n_file_rows - step;
+  long i;
+  int c;
+
+  if (n_from_file > block->n_rows)
+    n_from_file = block->n_rows;
+  if (n_from_file > 0 && read_stream_rows_pet(stream, block, step, n_from_file) != 0)
+    return -1;
+  for (i = (n_from_file > 0) ? n_from_file : 0; i < block->n_rows; i++)
+    for (c = 0; c < PET_FORCING_N_COLUMNS; c++)
+      block->base[c * block->column_stride + i] = stream->last_row[c];
+  return 0;
+}
+
+#if defined(PET_FORCING_PREFETCH)
+static void *prefetch_forcing_pet(void *arg)
+{
+  struct pet_forcing_stream *stream = (struct pet_forcing_stream *)arg;
+
+  pthread_mutex_lock(&stream->lock);
+  for (;;) {
+    long step;
+    int status;
+
+    while (!stream->quit && stream->request_step < 0)
+      pthread_cond_wait(&stream->wake, &stream->lock);
+    if (stream->quit)
+      break;
+    step = stream->request_step;
+    stream->request_step = -1;
+    stream->busy = 1;
+    pthread_mutex_unlock(&stream->lock);
+
+    status = fill_stream_window_pet(stream, &stream->spare, step);
+
+    pthread_mutex_lock(&stream->lock);
+    stream->spare.first_row = (status == 0) ? step : -1;
+    stream->busy = 0;
+    pthread_cond_signal(&stream->done);
+  }
+  pthread_mutex_unlock(&stream->lock);
+  return NULL;
+}
+
+// start the helper thread with a spare block the size of the window.  Returns 0, or -1 if it could not be started,
+// the forcing is then read by the thread running the model.
+static int start_forcing_prefetch_pet(pet_model* model)
+{
+  struct pet_forcing_stream *stream = model->forcing_stream;
+  const struct pet_forcing_block *block = &model->forcing_block;
+
+  stream->spare = *block;
+  stream->spare.base = pet_model_alloc(model, PET_FORCING_N_COLUMNS * block->column_stride * sizeof(double));
+  stream->spare.first_row = -1;
+  stream->request_step = -1;
+  if (stream->spare.base == NULL)
+    return -1;
+  pthread_mutex_init(&stream->lock, NULL);
+  pthread_cond_init(&stream->wake, NULL);
+  pthread_cond_init(&stream->done, NULL);
+  if (pthread_create(&stream->thread, NULL, prefetch_forcing_pet, stream) != 0) {
+    pthread_mutex_destroy(&stream->lock);
+    pthread_cond_destroy(&stream->wake);
+    pthread_cond_destroy(&stream->done);
+    return -1;
+  }
+  stream->prefetching = 1;
+  return 0;
+}
+
+static void stop_forcing_prefetch_pet(struct pet_forcing_stream *stream)
+{
+  if (!stream->prefetching)
+    return;
+  pthread_mutex_lock(&stream->lock);
+  stream->quit = 1;
+  pthread_cond_signal(&stream->wake);
+  pthread_mutex_unlock(&stream->lock);
+  pthread_join(stream->thread, NULL);
+  pthread_mutex_destroy(&stream->lock);
+  pthread_cond_destroy(&stream->wake);
+  pthread_cond_destroy(&stream->done);
+  stream->prefetching = 0;
+}
+#endif
+
+extern long advance_forcing_window_pet(pet_model* model, long step)
+{
+  struct pet_forcing_stream *stream = model->forcing_stream;
+  struct pet_forcing_block *block = &model->forcing_block;
+  int status;
+
+  if (stream == NULL)
+    return step;  // the whole record is loaded
+  if (step < 0)
+    return -1;
+
+#if defined(PET_FORCING_PREFETCH)
+  if (stream->prefetching) {
+    pthread_mutex_lock(&stream->lock);
+    while (stream->busy || stream->request_step >= 0)
+      pthread_cond_wait(&stream->done, &stream->lock);
+    if (stream->spare.first_row == step) {
+      // the helper has it ready, swap the blocks
+      struct pet_forcing_block next = stream->spare;
+      stream->spare = *block;
+      point_forcing_arrays_pet(model, next.base, next.n_rows, next.column_stride);
+      status = 0;
+    }
+    else
+      status = fill_stream_window_pet(stream, block, step);  // moved back, or off the end of the run
+    stream->spare.first_row = -1;
+    if (status == 0 && step + block->n_rows < model->bmi.num_timesteps) {
+      stream->request_step = step + block->n_rows;
+      pthread_cond_signal(&stream->wake);
+    }
+    pthread_mutex_unlock(&stream->lock);
+  }
+  else
+#endif
+    status = fill_stream_window_pet(stream, block, step);
+
+  if (status != 0) {
+    printf("Could not read forcing rows %ld to %ld from the forcing file\n", step, step + block->n_rows - 1);
+    return -1;
+  }
+  block->first_row = step;
+  return 0;
+}
+
+// open the file and load the first window.  Returns 0, or -1 (after printing why) with the file closed again.
+static int open_forcing_stream_pet(pet_model* model, const char* forcing_file)
+{
+  struct pet_forcing_stream *stream = pet_model_alloc(model, sizeof(struct pet_forcing_stream));
+  struct pet_forcing_bin_header *header;
+  long last_line_start = -1, file_size;
+  int c;
+
+  if (stream == NULL) {
+    printf("Problem allocating memory to stream the forcing file '%s'\n", forcing_file);
+    return -1;
+  }
+  header = &stream->header;
+  if ((stream->fp = fopen(forcing_file, "rb")) == NULL) {
+    printf("Configured forcing file '%s' could not be opened for reading\n", forcing_file);
+    return -1;
+  }
+  model->forcing_stream = stream;
+  stream->time_step_size_s = (double)model->bmi.time_step_size_s;
+
+  fseek(stream->fp, 0, SEEK_END);
+  file_size = ftell(stream->fp);
+  fseek(stream->fp, 0, SEEK_SET);
+  stream->is_binary = fread(header, sizeof(*header), 1, stream->fp) == 1 &&
+                      memcmp(header->magic, PET_FORCING_BIN_MAGIC, sizeof(PET_FORCING_BIN_MAGIC)) == 0;
+
+  if (stream->is_binary) {
+    int valid = header->version == PET_FORCING_BIN_VERSION && header->n_columns == PET_FORCING_N_COLUMNS &&
+                header->n_rows >= 0;
+    for (c = 0; c < PET_FORCING_N_COLUMNS && valid; c++)
+      valid = header->column_offset[c] >= (int64_t)sizeof(struct pet_forcing_bin_header) &&
+              (uint64_t)header->column_offset[c] + (uint64_t)header->n_rows * sizeof(double) <= (uint64_t)file_size;
+    if (!valid) {
+      printf("Binary forcing file '%s' is truncated or from an unsupported version\n", forcing_file);
+      free_aorc_forcing_pet(model);  // closes the file
+      return -1;
+    }
+    stream->n_file_rows = (long)header->n_rows;
+  }
+  else {
+    // skip the header line and count the rows, noting where the last one starts
+    int ch;
+    fseek(stream->fp, 0, SEEK_SET);
+    while ((ch = fgetc(stream->fp)) != EOF && ch != '\n')
+      ;
+    stream->data_start = ftell(stream->fp);
+    for (;;) {
+      long line_start = ftell(stream->fp);
+      if (read_stream_line_pet(stream) < 0)
+        break;
+      last_line_start = line_start;
+    }
+    stream->n_file_rows = stream->next_file_row;
+  }
+
+  if (stream->n_file_rows == 0) {
+    printf("Invalid header-only forcing file '%s'\n", forcing_file);
+    free_aorc_forcing_pet(model);
+    return -1;
+  }
+  if (model->bmi.num_timesteps <= 0)
+    model->bmi.num_timesteps = stream->n_file_rows;
+  if (model->forcing_window_steps > model->bmi.num_timesteps)
+    model->forcing_window_steps = model->bmi.num_timesteps;
+  if (alloc_forcing_arrays_pet(model, model->forcing_window_steps) != 0) {
+    free_aorc_forcing_pet(model);
+    return -1;
+  }
+
+  // the last row of the file, through row 0 of the window, which the first window then overwrites
+  if (!stream->is_binary) {
+    fseek(stream->fp, last_line_start, SEEK_SET);
+    stream->next_file_row = stream->n_file_rows - 1;
+  }
+  if (read_stream_rows_pet(stream, &model->forcing_block, stream->n_file_rows - 1, 1) != 0) {
+    printf("Could not read the forcing file '%s'\n", forcing_file);
+    free_aorc_forcing_pet(model);
+    return -1;
+  }
+  for (c = 0; c < PET_FORCING_N_COLUMNS; c++)
+    stream->last_row[c] = (*forcing_column_pet(model, c))[0];
+
+  // a helper thread is only worth it if there is a next window to read
+  if (model->forcing_prefetch && model->forcing_window_steps < model->bmi.num_timesteps) {
+#if defined(PET_FORCING_PREFETCH)
+    if (start_forcing_prefetch_pet(model) != 0)
+      printf("Could not start the forcing prefetch thread, reading '%s' in line\n", forcing_file);
+#else
+    printf("forcing_prefetch needs a library built with PET_FORCING_PREFETCH, reading '%s' in line\n", forcing_file);
+#endif
+  }
+
+  if (advance_forcing_window_pet(model, 0) != 0) {
+    free_aorc_forcing_pet(model);  // stops the prefetch thread too
+    return -1;
+  }
+
+  PET_LOG(model, PET_LOG_DEBUG, "streaming %ld rows of the forcing file for %ld time steps, %ld at a time%s\n",
+          stream->n_file_rows, model->bmi.num_timesteps, model->forcing_window_steps,
+          model->forcing_prefetch ? " with prefetch" : "");
+
+  model->bmi.current_time = model->forcing_data_time[0];
+  return 0;
+}
+
+//#####################################################################################################################
+extern int read_aorc_forcing_file_pet(pet_model* model, const char* forcing_file)
+{
+  size_t size;
+  char *data;
+  int keep_mapping = 0;
+  long n_rows, i;
+
+  model->forcing_mapping = NULL;
+  model->forcing_mapping_size = 0;
+  model->forcing_stream = NULL;
+
+  if (model->forcing_prefetch && model->forcing_window_steps <= 0)
+    model->forcing_window_steps = PET_FORCING_DEFAULT_WINDOW_STEPS;
+  if (model->forcing_window_steps > 0)
+    return open_forcing_stream_pet(model, forcing_file);
+
+  data = map_forcing_file_pet(forcing_file, &size);
+
+  if (data == NULL) {
+    printf("Configured forcing file '%s' could not be opened for reading\n", forcing_file);
+    return -1;
+  }
+
+  if (size >= sizeof(PET_FORCING_BIN_MAGIC) && memcmp(data, PET_FORCING_BIN_MAGIC, sizeof(PET_FORCING_BIN_MAGIC)) == 0) {
+    n_rows = read_forcing_binary_pet(model, data, size, &keep_mapping);
+    if (n_rows == -1)
+      printf("Binary forcing file '%s' is truncated or from an unsupported version\n", forcing_file);
+  }
+  else
+    n_rows = read_forcing_csv_pet(model, data, size);
+
+  if (n_rows < 0) {
+    unmap_forcing_file_pet(data, size);
+    return -1;
+  }
+
+  if (keep_mapping) {
+    model->forcing_mapping = data;
+    model->forcing_mapping_size = size;
+  }
+  else
+    unmap_forcing_file_pet(data, size);
+
+  if (n_rows == 0) {
+    printf("Invalid header-only forcing file '%s'\n", forcing_file);
+    return -1;
+  }
+
+  // a short file keeps its last row for the remaining timesteps
+  for (i = n_rows; i < model->bmi.num_timesteps; i++)
+    copy_forcing_row_pet(model, i, n_rows - 1);
+
+  PET_LOG(model, PET_LOG_DEBUG, "read %ld rows of the forcing file for %ld time steps\n", n_rows, model->bmi.num_timesteps);
+  if (PET_LOG_ON(model, PET_LOG_DUMP)) {
+    for (i = 0; i < model->bmi.num_timesteps; i++)
+      printf("precip %f surface pressure %f longwave %f shortwave %f humidity %f air temperature %f "
+             "u wind speed %f v wind speed %f \n",
+             model->forcing_data_precip_kg_per_m2[i], model->forcing_data_surface_pressure_Pa[i],
+             model->forcing_data_incoming_longwave_W_per_m2[i], model->forcing_data_incoming_shortwave_W_per_m2[i],
+             model->forcing_data_specific_humidity_2m_kg_per_kg[i], model->forcing_data_air_temperature_2m_K[i],
+             model->forcing_data_u_wind_speed_10m_m_per_s[i], model->forcing_data_v_wind_speed_10m_m_per_s[i]);
+  }
+
+  model->bmi.current_time = model->forcing_data_time[0];
+
+  return 0;
+}
+
+//#####################################################################################################################
+extern int write_forcing_binary_pet(const pet_model* model, const char* file_name)
+{
+  static const char zeros[PET_FORCING_BIN_ALIGNMENT] = {0};
+  struct pet_forcing_bin_header header;
+  long n_rows = model->bmi.num_timesteps;
+  // every column gets at least one spare row of zeros after it, like the n+1 heap arrays
+  int64_t column_bytes = ((n_rows + 1) * (int64_t)sizeof(double) + PET_FORCING_BIN_ALIGNMENT - 1) /
+                         PET_FORCING_BIN_ALIGNMENT * PET_FORCING_BIN_ALIGNMENT;
+  int64_t offset = ((int64_t)sizeof(header) + PET_FORCING_BIN_ALIGNMENT - 1) /
+                   PET_FORCING_BIN_ALIGNMENT * PET_FORCING_BIN_ALIGNMENT;
+  int64_t written;
+  FILE *fp;
+  int c;
+
+  if (model->forcing_stream != NULL) {
+    printf("Binary forcing file '%s' needs the whole forcing record, not a window of it\n", file_name);
+    return -1;
+  }
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, PET_FORCING_BIN_MAGIC, sizeof(PET_FORCING_BIN_MAGIC));
+  header.version = PET_FORCING_BIN_VERSION;
+  header.n_columns = PET_FORCING_N_COLUMNS;
+  header.n_rows = n_rows;
+  header.start_time = (n_rows > 0) ? model->forcing_data_time[0] : 0.0;
+  header.time_step_size_s = (double)model->bmi.time_step_size_s;
+  for (c = 0; c < PET_FORCING_N_COLUMNS; c++)
+    header.column_offset[c] = offset + c * column_bytes;
+
+  fp = fopen(file_name, "wb");
+  if (fp == NULL) {
+    printf("Binary forcing file '%s' could not be opened for writing\n", file_name);
+    return -1;
+  }
+  fwrite(&header, sizeof(header), 1, fp);
+  written = (int64_t)sizeof(header);
+  for (c = 0; c < PET_FORCING_N_COLUMNS; c++) {
+    const double *column = *forcing_column_pet((pet_model *)model, c);
+    while (written < header.column_offset[c]) {
+      int64_t pad = header.column_offset[c] - written;
+      if (pad > PET_FORCING_BIN_ALIGNMENT) pad = PET_FORCING_BIN_ALIGNMENT;
+      fwrite(zeros, 1, (size_t)pad, fp);
+      written += pad;
+    }
+    fwrite(column, sizeof(double), (size_t)n_rows, fp);
+    written += n_rows * (int64_t)sizeof(double);
+  }
+  // spare rows after the last column
+  while (written < offset + PET_FORCING_N_COLUMNS * column_bytes) {
+    int64_t pad = offset + PET_FORCING_N_COLUMNS * column_bytes - written;
+    if (pad > PET_FORCING_BIN_ALIGNMENT) pad = PET_FORCING_BIN_ALIGNMENT;
+    fwrite(zeros, 1, (size_t)pad, fp);
+    written += pad;
+  }
+  if (ferror(fp) | fclose(fp)) {  // both, so that the file is always closed
+    printf("Failed writing binary forcing file '%s'\n", file_name);
+    return -1;
+  }
+  return 0;
+}
+
+//#####################################################################################################################
+extern void free_aorc_forcing_pet(pet_model* model)
+{
+  if (model->forcing_stream != NULL) {
+#if defined(PET_FORCING_PREFETCH)
+    stop_forcing_prefetch_pet(model->forcing_stream);
+#endif
+    fclose(model->forcing_stream->fp);
+    model->forcing_stream = NULL;
+  }
+  if (model->forcing_mapping != NULL) {
+    unmap_forcing_file_pet(model->forcing_mapping, model->forcing_mapping_size);
+    model->forcing_mapping = NULL;
+    model->forcing_mapping_size = 0;
+  }
+  point_forcing_arrays_pet(model, NULL, 0, 0);
+}
@@ -0,0 +1,309 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "../include/pet.h"
+#include "../include/pet_batch.h"
+#include "../include/pet_output.h"
+
+// longest csv line a record can make: the catchment index and PET_OUTPUT_N_FIELDS numbers
+#define PET_OUTPUT_MAX_CSV_LINE (24 * (PET_OUTPUT_N_FIELDS + 1))
+
+static const char *field_names[PET_OUTPUT_N_FIELDS] = {
+  "time",
+  "water_potential_evaporation_flux",
+  "net_radiation_W_per_sq_m",
+  "air_temperature_C",
+  "wind_speed_m_per_s",
+  "vapor_pressure_deficit_Pa",
+  "water_potential_evaporation_depth_cumulative"
+};
+
+struct pet_output {
+  FILE              *fp;
+  pet_output_options options;
+  int                n_fields;
+  int                failed;          // a write went wrong, reported by pet_output_close()
+
+  // csv, and binary time major: records in the order they come
+  char              *buffer;
+  size_t             used;
+
+  // binary catchment major: a slice of slice_steps records per catchment
+  double            *slices;
+  long               slice_steps;
+  long              *slice_first_step;  // step of the first record in the slice of each catchment
+  long              *slice_used;        // records in the slice of each catchment
+  long              *next_step;         // step the next record of each catchment is for
+};
+
+static int host_is_big_endian(void)
+{
+  const uint16_t one = 1;
+  return *(const unsigned char *)&one == 0;
+}
+
+// n doubles to the file as little-endian, at the current position.  Byte swapping is done in place.
+static void write_doubles(pet_output *out, double *values, size_t n)
+{
+  if (host_is_big_endian()) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+      unsigned char *b = (unsigned char *)&values[i], t;
+      int k;
+      for (k = 0; k < 4; k++) {
+        t = b[k]; b[k] = b[7-k]; b[7-k] = t;
+      }
+    }
+  }
+  if (fwrite(values, sizeof(double), n, out->fp) != n)
+    out->failed = 1;
+}
+
+static void flush_buffer(pet_output *out)
+{
+  if (out->used == 0)
+    return;
+  if (out->options.format == PET_OUTPUT_BINARY)
+    write_doubles(out, (double *)out->buffer, out->used / sizeof(double));
+  else if (fwrite(out->buffer, 1, out->used, out->fp) != out->used)
+    out->failed = 1;
+  out->used = 0;
+}
+
+static void flush_slice(pet_output *out, long catchment)
+{
+  long n = out->slice_used[catchment];
+  long record = catchment * out->options.n_steps + out->slice_first_step[catchment];
+
+  if (n == 0)
+    return;
+  if (fseek(out->fp, (long)(record * out->n_fields * (long)sizeof(double)), SEEK_SET) != 0)
+    out->failed = 1;
+  else
+    write_doubles(out, out->slices + catchment * out->slice_steps * out->n_fields, (size_t)(n * out->n_fields));
+  out->slice_used[catchment] = 0;
+}
+
+//#####################################################################################################################
+
+extern pet_output *pet_output_open(const char *file_name, const pet_output_options *options)
+{
+  pet_output *out;
+  size_t buffer_bytes = (options->buffer_bytes > 0) ? options->buffer_bytes : PET_OUTPUT_DEFAULT_BUFFER_BYTES;
+  size_t record_bytes;
+  int f;
+
+  if (options->fields == 0 || options->fields >= (1u << PET_OUTPUT_N_FIELDS) || options->n_catchments < 1 ||
+      (options->format != PET_OUTPUT_CSV && options->format != PET_OUTPUT_BINARY) ||
+      (options->layout != PET_OUTPUT_TIME_MAJOR && options->layout != PET_OUTPUT_CATCHMENT_MAJOR)) {
+    printf("Output file '%s': fields, number of catchments, format or layout not valid\n", file_name);
+    return NULL;
+  }
+  if (options->layout == PET_OUTPUT_CATCHMENT_MAJOR &&
+      (options->format != PET_OUTPUT_BINARY || options->n_steps < 1)) {
+    printf("Output file '%s': the catchment major layout needs the binary format and the number of steps\n",
+           file_name);
+    return NULL;
+  }
+
+  out = (pet_output *) calloc(1, sizeof(pet_output));
+  if (out == NULL) {
+    printf("Problem allocating the output of '%s'\n", file_name);
+    return NULL;
+  }
+  out->options = *options;
+  for (f = 0; f < PET_OUTPUT_N_FIELDS; f++)
+    out->n_fields += (options->fields >> f) & 1;
+  record_bytes = out->n_fields * sizeof(double);
+
+  if (options->layout == PET_OUTPUT_CATCHMENT_MAJOR) {
+    long n = options->n_catchments;
+    out->slice_steps = (long)(buffer_bytes / (record_bytes * (size_t)n));
+    if (out->slice_steps < 1)
+      out->slice_steps = 1;
+    if (out->slice_steps > options->n_steps)
+      out->slice_steps = options->n_steps;
+    out->slices = (double *) malloc((size_t)(n * out->slice_steps) * record_bytes);
+    out->slice_first_step = (long *) calloc((size_t)n, sizeof(long));
+    out->slice_used = (long *) calloc((size_t)n, sizeof(long));
+    out->next_step = (long *) calloc((size_t)n, sizeof(long));
+  }
+  else {
+    // room for at least one record, a csv line of it can be longer than the doubles
+    if (buffer_bytes < PET_OUTPUT_MAX_CSV_LINE)
+      buffer_bytes = PET_OUTPUT_MAX_CSV_LINE;
+    out->options.buffer_bytes = buffer_bytes;
+    out->buffer = (char *) malloc(buffer_bytes);
+  }
+
+  out->fp = fopen(file_name, (options->format == PET_OUTPUT_BINARY) ? "wb" : "w");
+  if (out->fp == NULL || (out->slices == NULL && out->buffer == NULL) ||
+      (out->slices != NULL && (out->slice_first_step == NULL || out->slice_used == NULL || out->next_step == NULL))) {
+    printf("Output file '%s' could not be opened for writing\n", file_name);
+    if (out->fp != NULL)
+      fclose(out->fp);
+    out->fp = NULL;
+    pet_output_close(out);
+    return NULL;
+  }
+
+  if (options->format == PET_OUTPUT_CSV) {
+    const char *separator = "";
+    if (options->n_catchments > 1) {
+      fputs("catchment", out->fp);
+      separator = ",";
+    }
+    for (f = 0; f < PET_OUTPUT_N_FIELDS; f++)
+      if ((options->fields >> f) & 1) {
+        fprintf(out->fp, "%s%s", separator, field_names[f]);
+        separator = ",";
+      }
+    fputc('\n', out->fp);
+  }
+  return out;
+}
+
+// one record, values holds every field in bit order whether selected or not
+static int write_record(pet_output *out, long catchment, const double *values)
+{
+  int f;
+
+  if (catchment < 0 || catchment >= out->options.n_catchments) {
+    printf("Output of catchment %ld, there are %ld\n", catchment, out->options.n_catchments);
+    return -1;
+  }
+
+  if (out->options.format == PET_OUTPUT_CSV) {
+    char *line;
+    const char *separator = "";
+
+    if (out->used + PET_OUTPUT_MAX_CSV_LINE > out->options.buffer_bytes)
+      flush_buffer(out);
+    line = out->buffer + out->used;
+    if (out->options.n_catchments > 1) {
+      line += sprintf(line, "%ld", catchment);
+      separator = ",";
+    }
+    for (f = 0; f < PET_OUTPUT_N_FIELDS; f++)
+      if ((out->options.fields >> f) & 1) {
+        // whole seconds for the time, unless it is too big for that to fit the line
+        line += sprintf(line, (f == 0 && fabs(values[f]) < 1.0e15) ? "%s%.0f" : "%s%.9e", separator, values[f]);
+        separator = ",";
+      }
+    *line++ = '\n';
+    out->used = (size_t)(line - out->buffer);
+  }
+  else if (out->options.layout == PET_OUTPUT_TIME_MAJOR) {
+    double *record;
+
+    if (out->used + out->n_fields * sizeof(double) > out->options.buffer_bytes)
+      flush_buffer(out);
+    record = (double *)(out->buffer + out->used);
+    for (f = 0; f < PET_OUTPUT_N_FIELDS; f++)
+      if ((out->options.fields >> f) & 1)
+        *record++ = values[f];
+    out->used = (size_t)((char *)record - out->buffer);
+  }
+  else {
+    long step = out->next_step[catchment]++;
+    double *record;
+
+    if (step >= out->options.n_steps) {
+      printf("Output of step %ld of catchment %ld, there are %ld steps\n", step, catchment, out->options.n_steps);
+      return -1;
+    }
+    if (out->slice_used[catchment] == 0)
+      out->slice_first_step[catchment] = step;
+    record = out->slices + (catchment * out->slice_steps + out->slice_used[catchment]) * out->n_fields;
+    for (f = 0; f < PET_OUTPUT_N_FIELDS; f++)
+      if ((out->options.fields >> f) & 1)
+        *record++ = values[f];
+    if (++out->slice_used[catchment] == out->slice_steps)
+      flush_slice(out, catchment);
+  }
+  return out->failed ? -1 : 0;
+}
+
+extern int pet_output_write(pet_output *out, long catchment, double step_time_s, const pet_model *model)
+{
+  double values[PET_OUTPUT_N_FIELDS];
+
+  values[0] = step_time_s;
+  values[1] = model->pet_m_per_s;
+  values[2] = model->pet_forcing.net_radiation_W_per_sq_m;
+  values[3] = model->pet_forcing.air_temperature_C;
+  values[4] = model->pet_forcing.wind_speed_m_per_s;
+  values[5] = model->inter_vars.vapor_pressure_deficit_Pa;
+  values[6] = model->aggregates.cumulative_m;
+  return write_record(out, catchment, values);
+}
+
+extern int pet_output_write_batch(pet_output *out, double step_time_s, const pet_batch *batch)
+{
+  double values[PET_OUTPUT_N_FIELDS];
+  long i;
+
+  for (i = 0; i < batch->n_catchments; i++) {
+    values[0] = step_time_s;
+    values[1] = batch->pet_m_per_s[i];
+    values[2] = batch->pet_forcing.net_radiation_W_per_sq_m[i];
+    values[3] = batch->pet_forcing.air_temperature_C[i];
+    values[4] = batch->pet_forcing.wind_speed_m_per_s[i];
+    values[5] = batch->inter_vars.vapor_pressure_deficit_Pa[i];
+    values[6] = batch->aggregates.cumulative_m[i];
+    if (write_record(out, i, values) != 0)
+      return -1;
+  }
+  return 0;
+}
+
+extern int pet_output_write_series(pet_output *out, long catchment, double start_time_s, double time_step_size_s,
+                                   long n, const double *pet_m_per_s)
+{
+  double values[PET_OUTPUT_N_FIELDS] = {0.0};
+  long k;
+
+  if ((out->options.fields & ~(unsigned int)(PET_OUTPUT_TIME | PET_OUTPUT_PET)) != 0) {
+    printf("A run_pet_series output has only the time and PET fields\n");
+    return -1;
+  }
+  for (k = 0; k < n; k++) {
+    values[0] = start_time_s + k * time_step_size_s;
+    values[1] = pet_m_per_s[k];
+    if (write_record(out, catchment, values) != 0)
+      return -1;
+  }
+  return 0;
+}
+
+extern int pet_output_close(pet_output *out)
+{
+  int status;
+  long c;
+
+  if (out == NULL)
+    return -1;
+  if (out->fp != NULL) {
+    if (out->slices != NULL)
+      for (c = 0; c < out->options.n_catchments; c++)
+        flush_slice(out, c);
+    else
+      flush_buffer(out);
+    if ((ferror(out->fp) | fclose(out->fp)) != 0)  // both, so that the file is always closed
+      out->failed = 1;
+  }
+  else
+    out->failed = 1;
+  status = out->failed ? -1 : 0;
+
+  free(out->buffer);
+  free(out->slices);
+  free(out->slice_first_step);
+  free(out->slice_used);
+  free(out->next_step);
+  free(out);
+  return status;
+}
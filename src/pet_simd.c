@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <math.h>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "../include/pet_simd.h"
+
+// coefficients of the saturation vapor pressure curve, see calc_air_saturation_vapor_pressure_Pa() in pet_tools.h
+#define SVP_E0 611.0     // Pa, saturation vapor pressure at 0 C
+#define SVP_A  17.27
+#define SVP_B  237.3     // C, it is 237.3
+#define SVP_S  4098.0    // = SVP_A*SVP_B, rounded as in Chow, Maidment, and Mays eqn. 3.2.10
+
+//#####################################################################################################################
+// Vector exponential.  Cody-Waite reduction x = k*ln(2) + r with |r| <= ln(2)/2, a degree 13 Taylor polynomial
+// for exp(r) (truncation error below 1e-17), then scaling by 2^k through the exponent bits.  Arguments are clamped
+// to [-708, 709] so that 2^k stays a normal double, which is far outside the range the vapor pressure curve uses.
+//#####################################################################################################################
+#define EXP_LN2_HI  6.93147180369123816490e-01
+#define EXP_LN2_LO  1.90821492927058770002e-10
+#define EXP_LOG2E   1.44269504088896338700e+00
+#define EXP_MAGIC   6755399441055744.0          // 1.5*2^52, adding it leaves a small integer in the low mantissa bits
+
+#if defined(__AVX512F__)
+
+static inline __m512d exp_pd512(__m512d x)
+{
+  __m512d k, r, p;
+  __m512i bits;
+
+  x = _mm512_min_pd(_mm512_max_pd(x, _mm512_set1_pd(-708.0)), _mm512_set1_pd(709.0));
+  k = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(EXP_LOG2E)), _MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC);
+  r = _mm512_fnmadd_pd(k, _mm512_set1_pd(EXP_LN2_HI), x);
+  r = _mm512_fnmadd_pd(k, _mm512_set1_pd(EXP_LN2_LO), r);
+
+  p = _mm512_set1_pd(1.0/6227020800.0);                                   // 1/13!
+  p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0/479001600.0));
+  p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0/39916800.0));
+  p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0/3628800.0));
+  p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0/362880.0));
+  p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0/40320.0));
+  p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0/5040.0));
+  p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0/720.0));
+  p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0/120.0));
+  p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0/24.0));
+  p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0/6.0));
+  p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(0.5));
+  p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0));
+  p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0));
+
+  // 2^k: the biased exponent k+1023 ends up in the low mantissa bits, shift it into the exponent field
+  bits = _mm512_castpd_si512(_mm512_add_pd(k, _mm512_set1_pd(EXP_MAGIC + 1023.0)));
+  bits = _mm512_slli_epi64(bits, 52);
+  return _mm512_mul_pd(p, _mm512_castsi512_pd(bits));
+}
+
+#elif defined(__AVX2__)
+
+#if defined(__FMA__)
+#define MADD256(a, b, c) _mm256_fmadd_pd((a), (b), (c))
+#define NMADD256(a, b, c) _mm256_fnmadd_pd((a), (b), (c))
+#else
+#define MADD256(a, b, c) _mm256_add_pd(_mm256_mul_pd((a), (b)), (c))
+#define NMADD256(a, b, c) _mm256_sub_pd((c), _mm256_mul_pd((a), (b)))
+#endif
+
+static inline __m256d exp_pd256(__m256d x)
+{
+  __m256d k, r, p;
+  __m256i bits;
+
+  x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(-708.0)), _mm256_set1_pd(709.0));
+  k = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(EXP_LOG2E)), _MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC);
+  r = NMADD256(k, _mm256_set1_pd(EXP_LN2_HI), x);
+  r = NMADD256(k, _mm256_set1_pd(EXP_LN2_LO), r);
+
+  p = _mm256_set1_pd(1.0/6227020800.0);                                   // 1/13!
+  p = MADD256(p, r, _mm256_set1_pd(1.0/479001600.0));
+  p = MADD256(p, r, _mm256_set1_pd(1.0/39916800.0));
+  p = MADD256(p, r, _mm256_set1_pd(1.0/3628800.0));
+  p = MADD256(p, r, _mm256_set1_pd(1.0/362880.0));
+  p = MADD256(p, r, _mm256_set1_pd(1.0/40320.0));
+  p = MADD256(p, r, _mm256_set1_pd(1.0/5040.0));
+  p = MADD256(p, r, _mm256_set1_pd(1.0/720.0));
+  p = MADD256(p, r, _mm256_set1_pd(1.0/120.0));
+  p = MADD256(p, r, _mm256_set1_pd(1.0/24.0));
+  p = MADD256(p, r, _mm256_set1_pd(1.0/6.0));
+  p = MADD256(p, r, _mm256_set1_pd(0.5));
+  p = MADD256(p, r, _mm256_set1_pd(1.0));
+  p = MADD256(p, r, _mm256_set1_pd(1.0));
+
+  // 2^k: the biased exponent k+1023 ends up in the low mantissa bits, shift it into the exponent field
+  bits = _mm256_castpd_si256(_mm256_add_pd(k, _mm256_set1_pd(EXP_MAGIC + 1023.0)));
+  bits = _mm256_slli_epi64(bits, 52);
+  return _mm256_mul_pd(p, _mm256_castsi256_pd(bits));
+}
+
+#endif
+
+//#####################################################################################################################
+extern void calc_air_saturation_vapor_pressure_and_slope_array(const double *air_temperature_C,
+                                                               double *air_sat_vap_press_Pa,
+                                                               double *slope_of_air_sat_vap_press_curve_Pa_per_C,
+                                                               long n)
+{
+  long i = 0;
+
+#if defined(__AVX512F__)
+  for (; i < n; i += 8)
+  {
+    // the last partial vector is handled with masked loads and stores, so every element takes the same path
+    __mmask8 mask = (n - i >= 8) ? (__mmask8)0xFF : (__mmask8)((1u << (n - i)) - 1u);
+    __m512d T     = _mm512_mask_loadu_pd(_mm512_set1_pd(0.0), mask, air_temperature_C + i);
+    __m512d denom = _mm512_add_pd(_mm512_set1_pd(SVP_B), T);
+    __m512d e_sat = _mm512_mul_pd(_mm512_set1_pd(SVP_E0),
+                                  exp_pd512(_mm512_div_pd(_mm512_mul_pd(_mm512_set1_pd(SVP_A), T), denom)));
+    if (air_sat_vap_press_Pa != NULL)
+      _mm512_mask_storeu_pd(air_sat_vap_press_Pa + i, mask, e_sat);
+    if (slope_of_air_sat_vap_press_curve_Pa_per_C != NULL)
+      _mm512_mask_storeu_pd(slope_of_air_sat_vap_press_curve_Pa_per_C + i, mask,
+                            _mm512_div_pd(_mm512_mul_pd(_mm512_set1_pd(SVP_S), e_sat), _mm512_mul_pd(denom, denom)));
+  }
+#elif defined(__AVX2__)
+  for (; i < n; i += 4)
+  {
+    // the last partial vector is handled with masked loads and stores, so every element takes the same path
+    long left = n - i;
+    __m256i mask  = _mm256_set_epi64x(left > 3 ? -1 : 0, left > 2 ? -1 : 0, left > 1 ? -1 : 0, -1);
+    __m256d T     = _mm256_maskload_pd(air_temperature_C + i, mask);
+    __m256d denom = _mm256_add_pd(_mm256_set1_pd(SVP_B), T);
+    __m256d e_sat = _mm256_mul_pd(_mm256_set1_pd(SVP_E0),
+                                  exp_pd256(_mm256_div_pd(_mm256_mul_pd(_mm256_set1_pd(SVP_A), T), denom)));
+    if (air_sat_vap_press_Pa != NULL)
+      _mm256_maskstore_pd(air_sat_vap_press_Pa + i, mask, e_sat);
+    if (slope_of_air_sat_vap_press_curve_Pa_per_C != NULL)
+      _mm256_maskstore_pd(slope_of_air_sat_vap_press_curve_Pa_per_C + i, mask,
+                          _mm256_div_pd(_mm256_mul_pd(_mm256_set1_pd(SVP_S), e_sat), _mm256_mul_pd(denom, denom)));
+  }
+#else
+  for (; i < n; i++)
+  {
+    double T = air_temperature_C[i];
+    double e_sat = SVP_E0*exp(SVP_A*T/(SVP_B+T));
+    if (air_sat_vap_press_Pa != NULL)
+      air_sat_vap_press_Pa[i] = e_sat;
+    if (slope_of_air_sat_vap_press_curve_Pa_per_C != NULL)
+      slope_of_air_sat_vap_press_curve_Pa_per_C[i] = SVP_S*e_sat/pow((SVP_B+T),2.0);
+  }
+#endif
+}
+
+extern const char *pet_simd_kernel_name(void)
+{
+#if defined(__AVX512F__)
+  return "avx512";
+#elif defined(__AVX2__)
+  return "avx2";
+#else
+  return "scalar";
+#endif
+}
@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../include/pet.h"
+#include "../include/bmi.h"
+#include "../include/bmi_pet.h"
+
+/*
+    Tests the daily, monthly and cumulative PET depth outputs.  The forcing file of the config, which starts at
+    midnight on the first of a month, is run with num_timesteps long enough to cross into the next month (the last row
+    of the file is repeated).  After every Update the daily depth must equal the sum of the PET of the 24 steps of the
+    last complete day, the monthly depth the sum over the last complete month once one has passed, and the cumulative
+    depth the sum of every step so far, each to within a rounding of the exact (long double) sum.  A run with
+    run_pet_series must end with bitwise the same depths as the run with Update.
+    usage: run_pet_aggregate_test <config reading hourly forcing from file> <scratch config file>
+*/
+
+#define N_STEPS 800   // 33 days and 8 hours of hourly steps
+
+static int depth_differs(double depth, long double exact)
+{
+    return fabsl((long double)depth - exact) > 4.0L * 1.1e-16L * fabsl(exact);
+}
+
+int
+main(int argc, const char *argv[]){
+
+    if(argc<=2){
+        printf("\nmust include a configuration that reads forcing from file and a scratch file name...exiting\n\n");
+        exit(1);
+    }
+
+    printf("\nBEGIN AGGREGATE UNIT TEST\n*************************\n");
+
+    // the config with a longer run, the last value of a key in a config is the one used
+    char line[1024];
+    FILE *in = fopen(argv[1], "r"), *out = fopen(argv[2], "w");
+    if (in == NULL || out == NULL) return BMI_FAILURE;
+    while (fgets(line, sizeof(line), in) != NULL)
+        fputs(line, out);
+    fprintf(out, "\nnum_timesteps=%d\n", N_STEPS);
+    fclose(in);
+    fclose(out);
+
+    Bmi *model = (Bmi *) malloc(sizeof(Bmi));
+    register_bmi_pet(model);
+    if (model->initialize(model, argv[2]) == BMI_FAILURE) return BMI_FAILURE;
+    pet_model *pet = (pet_model *) model->data;
+    double dt = pet->bmi.time_step_size_s;
+    if (dt != 3600.0) return BMI_FAILURE;
+
+    long double day = 0.0L, month = 0.0L, cumulative = 0.0L, last_day = 0.0L, last_month = 0.0L;
+    long n_days = 0, n_months = 0, n_failed = 0;
+    for (long step = 0; step < N_STEPS; step++){
+        double flux, daily, monthly, cumulative_depth;
+        model->update(model);
+        model->get_value(model, "water_potential_evaporation_flux", &flux);
+        day += (long double)flux * dt;
+        month += (long double)flux * dt;
+        cumulative += (long double)flux * dt;
+        if ((step + 1) % 24 == 0){
+            last_day = day;
+            day = 0.0L;
+            n_days++;
+        }
+        if (step + 1 == 31 * 24){   // the file starts on the first of December
+            last_month = month;
+            month = 0.0L;
+            n_months++;
+        }
+        model->get_value(model, "water_potential_evaporation_depth_daily", &daily);
+        model->get_value(model, "water_potential_evaporation_depth_monthly", &monthly);
+        model->get_value(model, "water_potential_evaporation_depth_cumulative", &cumulative_depth);
+        n_failed += depth_differs(daily, last_day) || depth_differs(monthly, last_month) ||
+                    depth_differs(cumulative_depth, cumulative);
+    }
+    struct pet_aggregates updated = pet->aggregates;
+    printf(" %d steps, %ld days and %ld month closed, cumulative %.9f mm: %ld steps differ from the exact sums\n",
+           N_STEPS, n_days, n_months, updated.cumulative_m * 1000.0, n_failed);
+    model->finalize(model);
+
+    // the same through run_pet_series
+    if (model->initialize(model, argv[2]) == BMI_FAILURE) return BMI_FAILURE;
+    pet = (pet_model *) model->data;
+    double *pet_m_per_s = (double *) malloc(N_STEPS * sizeof(double));
+    long n_done = run_pet_series(pet, N_STEPS, pet_m_per_s);
+    int series_differs = n_done != N_STEPS || memcmp(&pet->aggregates, &updated, sizeof(updated)) != 0;
+    printf(" run_pet_series: %ld steps, aggregates %s\n", n_done, series_differs ? "DIFFER" : "the same");
+    model->finalize(model);
+    free(pet_m_per_s);
+    free(model->data);
+    free(model);
+    remove(argv[2]);
+
+    if (n_failed > 0 || series_differs || n_months != 1 || updated.monthly_m <= 0.0){
+        printf("\nAGGREGATE UNIT TEST FAILED\n");
+        return BMI_FAILURE;
+    }
+    printf("\n***********************\nEND AGGREGATE UNIT TEST\n\n");
+    return 0;
+}
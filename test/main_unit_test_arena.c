@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../include/pet.h"
+#include "../include/bmi.h"
+#include "../include/bmi_pet.h"
+#include "../include/pet_arena.h"
+
+#define N_CHURN 200
+
+/*
+    Tests the per instance arena of pet_arena.h: alignment, zeroing and recycling of arena memory, that Finalize
+    releases the arena and leaves an instance that can be initialized again, and that N_CHURN instances created and
+    finalized through one pet_arena_pool reuse the same arena and give bitwise the same PET as a fresh instance.
+    usage: run_pet_arena_test <config reading forcing from file>
+*/
+
+// run a whole forcing record through BMI, the PET of each step goes in a new array *pet_m_per_s
+static int run_record(Bmi *model, const char *config_file, double **pet_m_per_s, long *n_steps)
+{
+    if (model->initialize(model, config_file) == BMI_FAILURE) return BMI_FAILURE;
+    pet_model *pet = (pet_model *) model->data;
+    *n_steps = pet->bmi.num_timesteps;
+    *pet_m_per_s = (double *) malloc(*n_steps * sizeof(double));
+    for (long step = 0; step < *n_steps; step++){
+        model->update(model);
+        model->get_value(model, "water_potential_evaporation_flux", &(*pet_m_per_s)[step]);
+    }
+    return BMI_SUCCESS;
+}
+
+static int check_arena(void)
+{
+    int n_failed = 0;
+    pet_arena_pool *pool = pet_arena_pool_create(1);
+    pet_arena *arena = pet_arena_create(pool);
+
+    // small and large (own block) allocations, all aligned and zeroed
+    char *small = (char *) pet_arena_alloc(arena, 3);
+    double *large = (double *) pet_arena_alloc(arena, 100000 * sizeof(double));
+    char *copy = pet_arena_strdup(arena, "forcing/cat-67_2015.csv");
+    n_failed += ((uintptr_t)small % PET_ARENA_ALIGNMENT) != 0 || ((uintptr_t)large % PET_ARENA_ALIGNMENT) != 0;
+    n_failed += small[0] != 0 || large[0] != 0.0 || large[99999] != 0.0;
+    n_failed += strcmp(copy, "forcing/cat-67_2015.csv") != 0;
+    size_t reserved = pet_arena_reserved_bytes(arena);
+    memset(large, 0xff, 100000 * sizeof(double));
+
+    // back to the pool and out again: same blocks, memory zeroed again
+    pet_arena_destroy(arena);
+    pet_arena *recycled = pet_arena_create(pool);
+    pet_arena_alloc(recycled, 3);
+    double *large_again = (double *) pet_arena_alloc(recycled, 100000 * sizeof(double));
+    n_failed += recycled != arena || pet_arena_reserved_bytes(recycled) != reserved;
+    n_failed += large_again[0] != 0.0 || large_again[99999] != 0.0;
+    pet_arena_destroy(recycled);
+    pet_arena_pool_destroy(pool);
+
+    printf(" %-44s %lu bytes reserved, %d checks failed\n", "arena allocations:", (unsigned long)reserved, n_failed);
+    return n_failed;
+}
+
+int
+main(int argc, const char *argv[]){
+
+    if(argc<=1){
+        printf("\nmust include a configuration that reads forcing from file...exiting\n\n");
+        exit(1);
+    }
+
+    printf("\nBEGIN ARENA UNIT TEST\n*********************\n");
+
+    int n_failed = check_arena();
+
+    // reference run, no pool
+    Bmi *model = (Bmi *) malloc(sizeof(Bmi));
+    register_bmi_pet(model);
+    double *expected, *pet_m_per_s;
+    long n_steps, n_steps_again;
+    if (run_record(model, argv[1], &expected, &n_steps) == BMI_FAILURE) return BMI_FAILURE;
+    model->finalize(model);
+
+    // Finalize leaves an empty instance that can be initialized again
+    pet_model *pet = (pet_model *) model->data;
+    n_failed += pet->arena != NULL || pet->forcing_data_air_temperature_2m_K != NULL || pet->forcing_file != NULL;
+    if (run_record(model, argv[1], &pet_m_per_s, &n_steps_again) == BMI_FAILURE) return BMI_FAILURE;
+    n_failed += n_steps_again != n_steps || memcmp(pet_m_per_s, expected, n_steps * sizeof(double)) != 0;
+    model->finalize(model);
+    free(pet_m_per_s);
+    printf(" %-44s %ld steps, %s\n", "finalize and initialize again:", n_steps, n_failed ? "FAILED" : "same PET");
+
+    // instance churn through one pool
+    pet_arena_pool *pool = pet_arena_pool_create(1);
+    pet_arena *first_arena = NULL;
+    int n_different = 0, n_new_arenas = 0;
+    for (int i = 0; i < N_CHURN; i++){
+        Bmi *churned = (Bmi *) malloc(sizeof(Bmi));
+        register_bmi_pet(churned);
+        pet = (pet_model *) churned->data;
+        pet->arena_pool = pool;
+        if (run_record(churned, argv[1], &pet_m_per_s, &n_steps_again) == BMI_FAILURE) return BMI_FAILURE;
+        if (first_arena == NULL) first_arena = pet->arena;
+        n_new_arenas += pet->arena != first_arena;
+        n_different += n_steps_again != n_steps || memcmp(pet_m_per_s, expected, n_steps * sizeof(double)) != 0;
+        churned->finalize(churned);
+        free(pet_m_per_s);
+        free(churned->data);
+        free(churned);
+    }
+    pet_arena_pool_destroy(pool);
+    printf(" %-44s %d instances, %d new arenas, %d differ\n", "instance churn through a pool:", N_CHURN,
+           n_new_arenas, n_different);
+    n_failed += n_new_arenas + n_different;
+
+    free(model->data);
+    free(model);
+    free(expected);
+
+    if (n_failed > 0){
+        printf("\nARENA UNIT TEST FAILED\n");
+        return BMI_FAILURE;
+    }
+    printf("\n*******************\nEND ARENA UNIT TEST\n\n");
+    return 0;
+}
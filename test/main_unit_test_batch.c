@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../include/pet.h"
+#include "../include/bmi.h"
+#include "../include/bmi_pet.h"
+#include "../include/pet_batch.h"
+
+#define N_CATCHMENTS 3
+
+/*
+    Runs every PET method through the multi-catchment batch engine and through one BMI instance per catchment,
+    feeding both the same AORC forcing, and checks that the two agree at every timestep.
+    usage: run_pet_batch_test <config reading forcing from file> <config taking forcing from BMI>
+*/
+int
+main(int argc, const char *argv[]){
+
+    if(argc<=2){
+        printf("\nmust include a forcing-file configuration and a BMI-forcing configuration...exiting\n\n");
+        exit(1);
+    }
+
+    printf("\nBEGIN BATCH UNIT TEST\n*********************\n");
+
+    // One instance just to read the forcing file, the rows are shared out to the catchments below
+    Bmi *reader_bmi = (Bmi *) malloc(sizeof(Bmi));
+    register_bmi_pet(reader_bmi);
+    if (reader_bmi->initialize(reader_bmi, argv[1]) == BMI_FAILURE) return BMI_FAILURE;
+    pet_model *reader = (pet_model *) reader_bmi->data;
+    long n_rows = reader->bmi.num_timesteps;
+
+    int n_failed = 0;
+    for (int method = 1; method <= 5; method++){
+        Bmi *models[N_CATCHMENTS];
+        pet_batch batch;
+        double max_rel_diff = 0.0;
+
+        if (pet_batch_init(&batch, N_CATCHMENTS, method) != 0) return BMI_FAILURE;
+
+        for (int c = 0; c < N_CATCHMENTS; c++){
+            models[c] = (Bmi *) malloc(sizeof(Bmi));
+            register_bmi_pet(models[c]);
+            if (models[c]->initialize(models[c], argv[2]) == BMI_FAILURE) return BMI_FAILURE;
+            pet_model *pet = (pet_model *) models[c]->data;
+            pet->pet_method = method;
+            pet_setup(pet);
+            if (pet_batch_set_catchment(&batch, c, pet) != 0) return BMI_FAILURE;
+        }
+
+        for (long step = 0; step < n_rows; step++){
+            for (int c = 0; c < N_CATCHMENTS; c++){
+                // offset each catchment into a different part of the forcing record
+                long row = (step + c * n_rows / N_CATCHMENTS) % n_rows;
+                double lw = reader->forcing_data_incoming_longwave_W_per_m2[row];
+                double sw = reader->forcing_data_incoming_shortwave_W_per_m2[row];
+                double p  = reader->forcing_data_surface_pressure_Pa[row];
+                double q  = reader->forcing_data_specific_humidity_2m_kg_per_kg[row];
+                double t  = reader->forcing_data_air_temperature_2m_K[row];
+                double u  = reader->forcing_data_u_wind_speed_10m_m_per_s[row];
+                double v  = reader->forcing_data_v_wind_speed_10m_m_per_s[row];
+
+                models[c]->set_value(models[c], "land_surface_radiation~incoming~longwave__energy_flux", &lw);
+                models[c]->set_value(models[c], "land_surface_radiation~incoming~shortwave__energy_flux", &sw);
+                models[c]->set_value(models[c], "land_surface_air__pressure", &p);
+                models[c]->set_value(models[c], "atmosphere_air_water~vapor__relative_saturation", &q);
+                models[c]->set_value(models[c], "land_surface_air__temperature", &t);
+                models[c]->set_value(models[c], "land_surface_wind__x_component_of_velocity", &u);
+                models[c]->set_value(models[c], "land_surface_wind__y_component_of_velocity", &v);
+                models[c]->update(models[c]);
+
+                batch.forcing.incoming_longwave_W_per_m2[c]     = lw;
+                batch.forcing.incoming_shortwave_W_per_m2[c]    = sw;
+                batch.forcing.surface_pressure_Pa[c]            = p;
+                batch.forcing.specific_humidity_2m_kg_per_kg[c] = q;
+                batch.forcing.air_temperature_2m_K[c]           = t;
+                batch.forcing.u_wind_speed_10m_m_per_s[c]       = u;
+                batch.forcing.v_wind_speed_10m_m_per_s[c]       = v;
+            }
+            pet_batch_run(&batch);
+
+            for (int c = 0; c < N_CATCHMENTS; c++){
+                double expected, rel_diff;
+                models[c]->get_value(models[c], "water_potential_evaporation_flux", &expected);
+                rel_diff = fabs(batch.pet_m_per_s[c] - expected) / fmax(fabs(expected), 1.0e-20);
+                if (rel_diff > max_rel_diff) max_rel_diff = rel_diff;
+            }
+        }
+
+        printf(" method %d: %ld steps x %d catchments, max relative difference batch vs. BMI %e\n",
+               method, n_rows, N_CATCHMENTS, max_rel_diff);
+        if (max_rel_diff > 1.0e-12) n_failed++;
+
+        for (int c = 0; c < N_CATCHMENTS; c++)
+            models[c]->finalize(models[c]);
+        pet_batch_free(&batch);
+    }
+
+    reader_bmi->finalize(reader_bmi);
+
+    if (n_failed > 0){
+        printf("\n%d of 5 methods FAILED\n", n_failed);
+        return BMI_FAILURE;
+    }
+    printf("\n******************\nEND BATCH UNIT TEST\n\n");
+    return 0;
+}
@@ -383,6 +383,45 @@ main(int argc, const char *argv[]){
             }
         }
     }
+    // Test the variable handle extension: pet_resolve_var(), pet_set_by_handle() and pet_get_by_handle()
+    printf("\nTEST VARIABLE HANDLES\n*********************\n");
+    for (i=0; i<count_in+count_out; i++){
+        const char *var_name = (i < count_in) ? names_in[i] : names_out[i-count_in];
+        double value = 12.5 + i, by_name = 0.0, by_handle = 0.0;
+        int handle = pet_resolve_var(model, var_name);
+        if (handle < 0) return BMI_FAILURE;
+        status = pet_set_by_handle(model, handle, &value);
+        if (status == BMI_FAILURE) return BMI_FAILURE;
+        model->get_value(model, var_name, &by_name);
+        status = pet_get_by_handle(model, handle, &by_handle);
+        if (status == BMI_FAILURE || by_name != value || by_handle != value) return BMI_FAILURE;
+        printf("  %s: handle %d, set and get %f\n", var_name, handle, by_handle);
+    }
+    if (pet_resolve_var(model, "no_such_variable") != -1) return BMI_FAILURE;
+    if (pet_get_by_handle(model, count_in+count_out, &now) != BMI_FAILURE) return BMI_FAILURE;
+
+    // Test pet_set_forcing(), all seven inputs in one call
+    printf("\nTEST BULK FORCING SET\n*********************\n");
+    {
+        pet_forcing_inputs forcing = {301.5, 512.25, 98765.0, 0.0125, 295.75, 2.5, -1.25};
+        const struct { const char *name; double expected; } inputs[] = {
+            {"land_surface_radiation~incoming~longwave__energy_flux",  forcing.incoming_longwave_W_per_m2},
+            {"land_surface_radiation~incoming~shortwave__energy_flux", forcing.incoming_shortwave_W_per_m2},
+            {"land_surface_air__pressure",                             forcing.surface_pressure_Pa},
+            {"atmosphere_air_water~vapor__relative_saturation",        forcing.specific_humidity_2m_kg_per_kg},
+            {"land_surface_air__temperature",                          forcing.air_temperature_2m_K},
+            {"land_surface_wind__x_component_of_velocity",             forcing.u_wind_speed_10m_m_per_s},
+            {"land_surface_wind__y_component_of_velocity",             forcing.v_wind_speed_10m_m_per_s}
+        };
+        status = pet_set_forcing(model, &forcing);
+        if (status == BMI_FAILURE) return BMI_FAILURE;
+        for (i=0; i<7; i++){
+            double value = 0.0;
+            model->get_value(model, inputs[i].name, &value);
+            printf("  %s: %f\n", inputs[i].name, value);
+            if (value != inputs[i].expected) return BMI_FAILURE;
+        }
+    }
     free(names_out);
     free(names_in);
     // Test BMI: CONTROL FUNCTION update_until()
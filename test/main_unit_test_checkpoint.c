@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/pet.h"
+#include "../include/bmi.h"
+#include "../include/bmi_pet.h"
+#include "../include/pet_checkpoint.h"
+
+#define CHECKPOINT_STEP 300
+
+/*
+    Tests the checkpoints of pet_checkpoint.h.  The forcing file of the config is run through BMI update to
+    CHECKPOINT_STEP, checkpointed to memory and to a file, and run on to the end.  Runs restored from the checkpoint must
+    finish with bitwise the same PET and aggregates: a fresh instance restored from memory, the same instance restored
+    again after it has run to the end, and an instance streaming the forcing file (forcing_window_steps) that has run
+    elsewhere, restored from the file.  Damaged, truncated and unfitting checkpoints must be refused.
+    usage: run_pet_checkpoint_test <config reading forcing from file> <scratch file name>
+*/
+
+static Bmi *initialize(const char *config_file)
+{
+    Bmi *model = (Bmi *) malloc(sizeof(Bmi));
+    register_bmi_pet(model);
+    if (model->initialize(model, config_file) == BMI_FAILURE) exit(1);
+    return model;
+}
+
+static void finalize(Bmi *model)
+{
+    model->finalize(model);
+    free(model->data);
+    free(model);
+}
+
+// PET of the steps from the current one to the end
+static void run_to_end(Bmi *model, double *pet_m_per_s)
+{
+    pet_model *pet = (pet_model *) model->data;
+    for (long step = pet->bmi.current_step; step < pet->bmi.num_timesteps; step++){
+        if (model->update(model) == BMI_FAILURE) exit(1);
+        model->get_value(model, "water_potential_evaporation_flux", &pet_m_per_s[step]);
+    }
+}
+
+// the restored run against the original one
+static int same_run(const char *name, Bmi *model, const double *pet_m_per_s, const double *expected,
+                    const struct pet_aggregates *aggregates)
+{
+    pet_model *pet = (pet_model *) model->data;
+    long n = pet->bmi.num_timesteps - CHECKPOINT_STEP;
+    int same = memcmp(pet_m_per_s + CHECKPOINT_STEP, expected + CHECKPOINT_STEP, n * sizeof(double)) == 0 &&
+               memcmp(&pet->aggregates, aggregates, sizeof(*aggregates)) == 0;
+    printf(" %-40s %ld steps after the checkpoint, %s\n", name, n, same ? "same PET and aggregates" : "FAILED");
+    return !same;
+}
+
+int
+main(int argc, const char *argv[]){
+
+    if(argc<=2){
+        printf("\nmust include a configuration that reads forcing from file and a scratch file name...exiting\n\n");
+        exit(1);
+    }
+
+    printf("\nBEGIN CHECKPOINT UNIT TEST\n**************************\n");
+
+    char checkpoint_file[1024], streamed_config[1024], line[1024];
+    snprintf(checkpoint_file, sizeof(checkpoint_file), "%s.bin", argv[2]);
+    snprintf(streamed_config, sizeof(streamed_config), "%s.config", argv[2]);
+
+    // the original run, checkpointed at CHECKPOINT_STEP
+    Bmi *original = initialize(argv[1]);
+    pet_model *pet = (pet_model *) original->data;
+    long n_steps = pet->bmi.num_timesteps;
+    double *expected = (double *) calloc(n_steps, sizeof(double));
+    double *pet_m_per_s = (double *) calloc(n_steps, sizeof(double));
+    for (long step = 0; step < CHECKPOINT_STEP; step++)
+        original->update(original);
+    size_t size = pet_checkpoint_size(pet);
+    void *checkpoint = malloc(size);
+    int n_failed = pet_checkpoint_save(pet, checkpoint, size) != size;
+    n_failed += pet_checkpoint_save_file(pet, checkpoint_file) != 0;
+    n_failed += pet_checkpoint_save(pet, checkpoint, size - 1) != 0;   // buffer too small
+    printf(" checkpoint of %zu bytes at step %d\n", size, CHECKPOINT_STEP);
+    run_to_end(original, expected);
+    struct pet_aggregates aggregates = pet->aggregates;
+    finalize(original);
+
+    // a fresh instance from memory, then the same instance again once it has run to the end
+    Bmi *restored = initialize(argv[1]);
+    n_failed += pet_checkpoint_restore((pet_model *) restored->data, checkpoint, size) != 0;
+    run_to_end(restored, pet_m_per_s);
+    n_failed += same_run("fresh instance, from memory", restored, pet_m_per_s, expected, &aggregates);
+    memset(pet_m_per_s, 0, n_steps * sizeof(double));
+    n_failed += pet_checkpoint_restore((pet_model *) restored->data, checkpoint, size) != 0;
+    run_to_end(restored, pet_m_per_s);
+    n_failed += same_run("same instance again, from memory", restored, pet_m_per_s, expected, &aggregates);
+
+    // refused: damaged, truncated, another pet method
+    unsigned char *damaged = (unsigned char *) malloc(size);
+    memcpy(damaged, checkpoint, size);
+    damaged[size - 1] ^= 1;
+    int refused = pet_checkpoint_restore((pet_model *) restored->data, damaged, size) != 0;
+    refused &= pet_checkpoint_restore((pet_model *) restored->data, checkpoint, size - 1) != 0;
+    ((pet_model *) restored->data)->pet_method = 1;
+    refused &= pet_checkpoint_restore((pet_model *) restored->data, checkpoint, size) != 0;
+    printf(" damaged, truncated and unfitting checkpoints %s\n", refused ? "refused" : "NOT REFUSED");
+    n_failed += !refused;
+    free(damaged);
+    finalize(restored);
+
+    // an instance streaming the forcing, its window elsewhere, from the file
+    FILE *in = fopen(argv[1], "r"), *out = fopen(streamed_config, "w");
+    if (in == NULL || out == NULL) return BMI_FAILURE;
+    while (fgets(line, sizeof(line), in) != NULL)
+        fputs(line, out);
+    fprintf(out, "\nforcing_window_steps=24\n");
+    fclose(in);
+    fclose(out);
+    Bmi *streamed = initialize(streamed_config);
+    for (long step = 0; step < 50; step++)
+        streamed->update(streamed);
+    memset(pet_m_per_s, 0, n_steps * sizeof(double));
+    n_failed += pet_checkpoint_restore_file((pet_model *) streamed->data, checkpoint_file) != 0;
+    run_to_end(streamed, pet_m_per_s);
+    n_failed += same_run("streamed forcing, from file", streamed, pet_m_per_s, expected, &aggregates);
+    finalize(streamed);
+
+    free(checkpoint);
+    free(expected);
+    free(pet_m_per_s);
+    remove(checkpoint_file);
+    remove(streamed_config);
+
+    if (n_failed > 0){
+        printf("\nCHECKPOINT UNIT TEST FAILED\n");
+        return BMI_FAILURE;
+    }
+    printf("\n************************\nEND CHECKPOINT UNIT TEST\n\n");
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "../include/pet.h"
+#include "../include/pet_forcing.h"
+#include "../include/pet_arena.h"
+
+/*
+    Checks the timestamp parser against known values.  Then reads an AORC forcing csv, writes it out in the binary columnar format and reads that back, and checks that every
+    forcing array is identical.  The binary file is written twice, once with the time step of the read (mapped with
+    no copy) and once with a different time step (precip rescaled on load), and each is read for the rows in the file
+    and for more rows than the file holds (last row repeated).  A file cut short after the rows of its last column, with
+    no spare rows, must be copied rather than mapped.  Every read must leave the arrays in one 64 byte aligned forcing
+    block, as pet_model.forcing_block describes it.
+    usage: run_pet_forcing_test <forcing csv> <scratch binary file>
+*/
+// the forcing_data_* arrays must be the columns of forcing_block, in the order of enum pet_forcing_column
+static int
+check_forcing_block(const pet_model *model)
+{
+    const struct pet_forcing_block *block = &model->forcing_block;
+    const double *columns[PET_FORCING_N_COLUMNS] = {
+        model->forcing_data_time, model->forcing_data_precip_kg_per_m2, model->forcing_data_incoming_longwave_W_per_m2,
+        model->forcing_data_incoming_shortwave_W_per_m2, model->forcing_data_surface_pressure_Pa,
+        model->forcing_data_specific_humidity_2m_kg_per_kg, model->forcing_data_air_temperature_2m_K,
+        model->forcing_data_u_wind_speed_10m_m_per_s, model->forcing_data_v_wind_speed_10m_m_per_s
+    };
+    int n_wrong = 0;
+
+    n_wrong += ((uintptr_t)block->base % PET_FORCING_BIN_ALIGNMENT) != 0;
+    n_wrong += (block->column_stride * sizeof(double)) % PET_FORCING_BIN_ALIGNMENT != 0;
+    n_wrong += block->column_stride <= block->n_rows || block->n_rows < model->bmi.num_timesteps;
+    for (int c = 0; c < PET_FORCING_N_COLUMNS; c++)
+        n_wrong += columns[c] != block->base + c * block->column_stride;
+    return n_wrong;
+}
+
+static int
+compare_forcing(const char *label, pet_model *expected, pet_model *actual)
+{
+    size_t n_bytes = expected->bmi.num_timesteps * sizeof(double);
+    int n_different = 0;
+
+    n_different += memcmp(expected->forcing_data_time, actual->forcing_data_time, n_bytes) != 0;
+    n_different += memcmp(expected->forcing_data_precip_kg_per_m2, actual->forcing_data_precip_kg_per_m2, n_bytes) != 0;
+    n_different += memcmp(expected->forcing_data_incoming_longwave_W_per_m2,
+                          actual->forcing_data_incoming_longwave_W_per_m2, n_bytes) != 0;
+    n_different += memcmp(expected->forcing_data_incoming_shortwave_W_per_m2,
+                          actual->forcing_data_incoming_shortwave_W_per_m2, n_bytes) != 0;
+    n_different += memcmp(expected->forcing_data_surface_pressure_Pa, actual->forcing_data_surface_pressure_Pa, n_bytes) != 0;
+    n_different += memcmp(expected->forcing_data_specific_humidity_2m_kg_per_kg,
+                          actual->forcing_data_specific_humidity_2m_kg_per_kg, n_bytes) != 0;
+    n_different += memcmp(expected->forcing_data_air_temperature_2m_K, actual->forcing_data_air_temperature_2m_K, n_bytes) != 0;
+    n_different += memcmp(expected->forcing_data_u_wind_speed_10m_m_per_s,
+                          actual->forcing_data_u_wind_speed_10m_m_per_s, n_bytes) != 0;
+    n_different += memcmp(expected->forcing_data_v_wind_speed_10m_m_per_s,
+                          actual->forcing_data_v_wind_speed_10m_m_per_s, n_bytes) != 0;
+    n_different += expected->bmi.current_time != actual->bmi.current_time;
+    n_different += check_forcing_block(actual) != 0;
+
+    printf(" %-44s %ld rows, %s, %d arrays differ\n", label, actual->bmi.num_timesteps,
+           actual->forcing_mapping != NULL ? "mapped" : "in arena", n_different);
+    return n_different;
+}
+
+// known seconds since 1970 UTC, from `date -u -d <timestamp> +%s`
+static int
+check_timestamps(void)
+{
+    const char *timestamps[] = {"1970-01-01 00:00:00", "2015-12-01 00:00:00", "2015-12-01 01:00:00",
+                                "2000-02-29 12:34:56", "1969-12-31 23:59:59", "2100-03-01 00:00:00",
+                                "1900-01-01 00:00:00", "2015-12-31 23:00:00", "2016-01-01"};
+    const double expected[] = {0.0, 1448928000.0, 1448931600.0, 951827696.0, -1.0, 4107542400.0,
+                               -2208988800.0, 1451602800.0, 1451606400.0};
+    long n = sizeof(expected) / sizeof(expected[0]);
+    double column[sizeof(expected) / sizeof(expected[0])];
+    int n_different = 0;
+
+    for (long i = 0; i < n; i++){
+        double seconds = 0.0;
+        if (parse_timestamp_pet(timestamps[i], &seconds) == NULL || seconds != expected[i]){
+            printf(" timestamp %s parsed as %.1f, expected %.1f\n", timestamps[i], seconds, expected[i]);
+            n_different++;
+        }
+    }
+    n_different += parse_timestamp_column_pet(timestamps, n, column) != 0;
+    n_different += memcmp(column, expected, sizeof(column)) != 0;
+    n_different += parse_timestamp_pet("precip_rate", column) != NULL;
+
+    printf(" %-44s %ld timestamps, %d wrong\n", "timestamp parser:", n, n_different);
+    return n_different;
+}
+
+static pet_model *
+read_forcing(const char *file_name, int time_step_size_s, long num_timesteps)
+{
+    pet_model *model = (pet_model *) calloc(1, sizeof(pet_model));
+    model->bmi.time_step_size_s = time_step_size_s;
+    model->bmi.num_timesteps = num_timesteps;
+    if (read_aorc_forcing_file_pet(model, file_name) != 0)
+        exit(1);
+    return model;
+}
+
+// free_pet_model() without the rest of the library: the arrays read from a csv are in the arena of the model
+static void
+free_forcing(pet_model *model)
+{
+    free_aorc_forcing_pet(model);
+    pet_arena_destroy(model->arena);
+    free(model);
+}
+
+int
+main(int argc, const char *argv[]){
+
+    if(argc<=2){
+        printf("\nmust include a forcing csv and a scratch file name...exiting\n\n");
+        exit(1);
+    }
+
+    printf("\nBEGIN FORCING UNIT TEST\n***********************\n");
+
+    int n_failed = 0;
+    n_failed += check_timestamps() != 0;
+    pet_model *csv = read_forcing(argv[1], 3600, 0);
+    long n_rows = csv->bmi.num_timesteps;
+    pet_model *csv_long = read_forcing(argv[1], 3600, n_rows + 10);
+
+    for (int write_step = 3600; write_step >= 1800; write_step -= 1800){
+        char label[100];
+        // as pet_convert_forcing does, with the given time step
+        pet_model *source = read_forcing(argv[1], write_step, 0);
+        if (write_forcing_binary_pet(source, argv[2]) != 0) return 1;
+        free_forcing(source);
+
+        pet_model *binary = read_forcing(argv[2], 3600, n_rows);
+        sprintf(label, "binary written with dt %d:", write_step);
+        n_failed += compare_forcing(label, csv, binary) != 0;
+        free_forcing(binary);
+
+        binary = read_forcing(argv[2], 3600, n_rows + 10);
+        sprintf(label, "binary written with dt %d, past the end:", write_step);
+        n_failed += compare_forcing(label, csv_long, binary) != 0;
+        free_forcing(binary);
+    }
+
+    // the spare rows after the last column cut off: the block would run past the end of the mapping
+    pet_model *source = read_forcing(argv[1], 3600, 0);
+    if (write_forcing_binary_pet(source, argv[2]) != 0) return 1;
+    free_forcing(source);
+    struct pet_forcing_bin_header header;
+    FILE *fp = fopen(argv[2], "rb");
+    if (fp == NULL || fread(&header, sizeof(header), 1, fp) != 1) return 1;
+    fclose(fp);
+    if (truncate(argv[2], header.column_offset[PET_FORCING_N_COLUMNS - 1] + n_rows * sizeof(double)) != 0) return 1;
+    pet_model *binary = read_forcing(argv[2], 3600, n_rows);
+    n_failed += compare_forcing("binary without spare rows:", csv, binary) != 0;
+    n_failed += binary->forcing_mapping != NULL;
+    free_forcing(binary);
+    remove(argv[2]);
+
+    if (n_failed > 0){
+        printf("\n%d comparisons FAILED\n", n_failed);
+        return 1;
+    }
+    printf("\n*********************\nEND FORCING UNIT TEST\n\n");
+    return 0;
+}
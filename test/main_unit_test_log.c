@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../include/pet.h"
+#include "../include/bmi.h"
+#include "../include/bmi_pet.h"
+#include "../include/pet_log.h"
+
+#define N_STEPS 24
+
+/*
+    Tests the verbose levels of pet_log.h.  The config is run for N_STEPS steps with verbose from 0 to PET_LOG_DUMP,
+    stdout and stderr going to a scratch file.  The PET must not depend on verbose.  Built with the default
+    PET_LOG_MAX_LEVEL, verbose 0 must print nothing, verbose 1 something, and each higher level no less than the one
+    below; built with -DPET_LOG_MAX_LEVEL=0 (like the library it is linked with), nothing must be printed at any
+    level.
+    usage: run_pet_log_test <config reading forcing from file> <scratch file name>
+*/
+
+// the config with verbose set, the last value of a key in a config is the one used
+static int write_config(const char *config_file, const char *scratch_config, int verbose)
+{
+    char line[1024];
+    FILE *in = fopen(config_file, "r"), *out = fopen(scratch_config, "w");
+    if (in == NULL || out == NULL) return BMI_FAILURE;
+    while (fgets(line, sizeof(line), in) != NULL)
+        fputs(line, out);
+    fprintf(out, "\nverbose=%d\n", verbose);
+    fclose(in);
+    return fclose(out) == 0 ? BMI_SUCCESS : BMI_FAILURE;
+}
+
+// PET of every step, and the bytes printed on the way (to stdout or stderr)
+static int run_verbose(const char *scratch_config, const char *scratch_output, double *pet_m_per_s, long *n_printed)
+{
+    int status = BMI_SUCCESS;
+    int saved_stdout = dup(fileno(stdout)), saved_stderr = dup(fileno(stderr));
+    fflush(stdout);
+    fflush(stderr);
+    if (freopen(scratch_output, "w", stdout) == NULL) return BMI_FAILURE;
+    dup2(fileno(stdout), fileno(stderr));
+
+    Bmi *model = (Bmi *) malloc(sizeof(Bmi));
+    register_bmi_pet(model);
+    if (model->initialize(model, scratch_config) == BMI_FAILURE)
+        status = BMI_FAILURE;
+    for (long step = 0; step < N_STEPS && status == BMI_SUCCESS; step++){
+        if (model->update(model) == BMI_FAILURE)
+            status = BMI_FAILURE;
+        model->get_value(model, "water_potential_evaporation_flux", &pet_m_per_s[step]);
+    }
+    model->finalize(model);
+    free(model->data);
+    free(model);
+
+    fflush(stderr);
+    fflush(stdout);
+    *n_printed = lseek(fileno(stdout), 0, SEEK_END);
+    dup2(saved_stdout, fileno(stdout));
+    dup2(saved_stderr, fileno(stderr));
+    close(saved_stdout);
+    close(saved_stderr);
+    clearerr(stdout);
+    return status;
+}
+
+int
+main(int argc, const char *argv[]){
+
+    if(argc<=2){
+        printf("\nmust include a configuration that reads forcing from file and a scratch file name...exiting\n\n");
+        exit(1);
+    }
+
+    printf("\nBEGIN LOG UNIT TEST (PET_LOG_MAX_LEVEL %d)\n*******************************************\n",
+           PET_LOG_MAX_LEVEL);
+
+    char scratch_config[1024], scratch_output[1024];
+    snprintf(scratch_config, sizeof(scratch_config), "%s.config", argv[2]);
+    snprintf(scratch_output, sizeof(scratch_output), "%s.out", argv[2]);
+
+    double expected[N_STEPS], pet_m_per_s[N_STEPS];
+    long n_printed, last_printed = 0;
+    int n_failed = 0;
+    for (int verbose = 0; verbose <= PET_LOG_DUMP; verbose++){
+        if (write_config(argv[1], scratch_config, verbose) == BMI_FAILURE ||
+            run_verbose(scratch_config, scratch_output, verbose ? pet_m_per_s : expected, &n_printed) == BMI_FAILURE){
+            printf(" verbose %d: run failed\n", verbose);
+            n_failed++;
+            continue;
+        }
+        int wrong = verbose > 0 && memcmp(pet_m_per_s, expected, sizeof(expected)) != 0;
+        if (PET_LOG_MAX_LEVEL == 0 || verbose == 0)
+            wrong |= n_printed != 0;
+        else
+            wrong |= n_printed < last_printed || (verbose == PET_LOG_INFO && n_printed == 0);
+        printf(" verbose %d: %8ld bytes printed over %d steps, %s\n", verbose, n_printed, N_STEPS,
+               wrong ? "FAILED" : "ok");
+        last_printed = n_printed;
+        n_failed += wrong;
+    }
+    remove(scratch_config);
+    remove(scratch_output);
+
+    if (n_failed > 0){
+        printf("\nLOG UNIT TEST FAILED\n");
+        return BMI_FAILURE;
+    }
+    printf("\n*****************\nEND LOG UNIT TEST\n\n");
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../include/pet.h"
+#include "../include/bmi.h"
+#include "../include/bmi_pet.h"
+#include "../include/pet_output.h"
+
+#define N_CATCHMENTS 3
+#define BUFFER_BYTES 4096   // small, so that the buffers are flushed many times over the record
+
+/*
+    Tests the buffered output writer of pet_output.h.  N_CATCHMENTS instances (different PET methods) are stepped
+    together through the forcing record with BMI update, and every step of every instance is written as a csv, as a
+    time major binary file and as a catchment major binary file, all with a small buffer.  The files are read back and
+    every value must be where the layout puts it: bitwise for binary, to the 10 digits written for csv.
+    usage: run_pet_output_test <config reading forcing from file> <scratch file name>
+*/
+
+static const unsigned int csv_fields = PET_OUTPUT_TIME | PET_OUTPUT_PET | PET_OUTPUT_CUMULATIVE_DEPTH;
+static const unsigned int all_fields = (1u << PET_OUTPUT_N_FIELDS) - 1;
+
+static pet_output *open_output(const char *file_name, int format, int layout, unsigned int fields, long n_steps)
+{
+    pet_output_options options;
+    memset(&options, 0, sizeof(options));
+    options.format = format;
+    options.layout = layout;
+    options.fields = fields;
+    options.n_catchments = N_CATCHMENTS;
+    options.n_steps = n_steps;
+    options.buffer_bytes = BUFFER_BYTES;
+    return pet_output_open(file_name, &options);
+}
+
+// the values of the binary file against the expected records, in the order of the layout
+static long check_binary(const char *file_name, const double *expected, long n_steps, int layout)
+{
+    long n_values = N_CATCHMENTS * n_steps * PET_OUTPUT_N_FIELDS, n_wrong = 0;
+    double *values = (double *) malloc(n_values * sizeof(double));
+    FILE *fp = fopen(file_name, "rb");
+    if (fp == NULL || fread(values, sizeof(double), n_values, fp) != (size_t)n_values || fgetc(fp) != EOF)
+        n_wrong = n_values;
+    if (fp != NULL) fclose(fp);
+    for (long i = 0; i < n_values && n_wrong == 0; i++){
+        long record = i / PET_OUTPUT_N_FIELDS, c, step;
+        if (layout == PET_OUTPUT_TIME_MAJOR){
+            step = record / N_CATCHMENTS;
+            c = record % N_CATCHMENTS;
+        }
+        else {
+            c = record / n_steps;
+            step = record % n_steps;
+        }
+        n_wrong += values[i] != expected[(c * n_steps + step) * PET_OUTPUT_N_FIELDS + i % PET_OUTPUT_N_FIELDS];
+    }
+    free(values);
+    return n_wrong;
+}
+
+static long check_csv(const char *file_name, const double *expected, long n_steps)
+{
+    char line[1024];
+    long n_wrong = 0, n_lines = 0;
+    FILE *fp = fopen(file_name, "r");
+    if (fp == NULL) return 1;
+    if (fgets(line, sizeof(line), fp) == NULL ||
+        strcmp(line, "catchment,time,water_potential_evaporation_flux,"
+                     "water_potential_evaporation_depth_cumulative\n") != 0)
+        n_wrong++;
+    while (fgets(line, sizeof(line), fp) != NULL){
+        long step = n_lines / N_CATCHMENTS, c;
+        double time, pet, cumulative;
+        const double *record = &expected[((n_lines % N_CATCHMENTS) * n_steps + step) * PET_OUTPUT_N_FIELDS];
+        if (sscanf(line, "%ld,%lf,%lf,%lf", &c, &time, &pet, &cumulative) != 4 || c != n_lines % N_CATCHMENTS ||
+            time != record[0] || fabs(pet - record[1]) > 1.0e-9 * fabs(record[1]) ||
+            fabs(cumulative - record[6]) > 1.0e-9 * fabs(record[6]))
+            n_wrong++;
+        n_lines++;
+    }
+    fclose(fp);
+    return n_wrong + (n_lines != N_CATCHMENTS * n_steps);
+}
+
+int
+main(int argc, const char *argv[]){
+
+    if(argc<=2){
+        printf("\nmust include a configuration that reads forcing from file and a scratch file name...exiting\n\n");
+        exit(1);
+    }
+
+    printf("\nBEGIN OUTPUT UNIT TEST\n**********************\n");
+
+    Bmi *models[N_CATCHMENTS];
+    for (int c = 0; c < N_CATCHMENTS; c++){
+        models[c] = (Bmi *) malloc(sizeof(Bmi));
+        register_bmi_pet(models[c]);
+        if (models[c]->initialize(models[c], argv[1]) == BMI_FAILURE) return BMI_FAILURE;
+        pet_model *pet = (pet_model *) models[c]->data;
+        pet->pet_method = 1 + 2 * c;
+        pet_setup(pet);
+    }
+    long n_steps = ((pet_model *) models[0]->data)->bmi.num_timesteps;
+
+    char csv_file[1024], time_major_file[1024], catchment_major_file[1024];
+    snprintf(csv_file, sizeof(csv_file), "%s.csv", argv[2]);
+    snprintf(time_major_file, sizeof(time_major_file), "%s.time.bin", argv[2]);
+    snprintf(catchment_major_file, sizeof(catchment_major_file), "%s.catchment.bin", argv[2]);
+    pet_output *csv = open_output(csv_file, PET_OUTPUT_CSV, PET_OUTPUT_TIME_MAJOR, csv_fields, n_steps);
+    pet_output *time_major = open_output(time_major_file, PET_OUTPUT_BINARY, PET_OUTPUT_TIME_MAJOR, all_fields, n_steps);
+    pet_output *catchment_major = open_output(catchment_major_file, PET_OUTPUT_BINARY, PET_OUTPUT_CATCHMENT_MAJOR,
+                                              all_fields, n_steps);
+    if (csv == NULL || time_major == NULL || catchment_major == NULL) return BMI_FAILURE;
+
+    // the records as they should come back, [catchment][step][field]
+    double *expected = (double *) malloc(N_CATCHMENTS * n_steps * PET_OUTPUT_N_FIELDS * sizeof(double));
+    int n_failed = 0;
+    for (long step = 0; step < n_steps; step++){
+        for (int c = 0; c < N_CATCHMENTS; c++){
+            pet_model *pet = (pet_model *) models[c]->data;
+            double step_time = pet->bmi.current_time;
+            models[c]->update(models[c]);
+            double *record = &expected[(c * n_steps + step) * PET_OUTPUT_N_FIELDS];
+            record[0] = step_time;
+            record[1] = pet->pet_m_per_s;
+            record[2] = pet->pet_forcing.net_radiation_W_per_sq_m;
+            record[3] = pet->pet_forcing.air_temperature_C;
+            record[4] = pet->pet_forcing.wind_speed_m_per_s;
+            record[5] = pet->inter_vars.vapor_pressure_deficit_Pa;
+            record[6] = pet->aggregates.cumulative_m;
+            n_failed += pet_output_write(csv, c, step_time, pet) != 0;
+            n_failed += pet_output_write(time_major, c, step_time, pet) != 0;
+            n_failed += pet_output_write(catchment_major, c, step_time, pet) != 0;
+        }
+    }
+    n_failed += pet_output_close(csv) != 0;
+    n_failed += pet_output_close(time_major) != 0;
+    n_failed += pet_output_close(catchment_major) != 0;
+
+    long n_wrong_csv = check_csv(csv_file, expected, n_steps);
+    long n_wrong_time = check_binary(time_major_file, expected, n_steps, PET_OUTPUT_TIME_MAJOR);
+    long n_wrong_catchment = check_binary(catchment_major_file, expected, n_steps, PET_OUTPUT_CATCHMENT_MAJOR);
+    printf(" %d catchments x %ld steps, values out of place: csv %ld, binary time major %ld, "
+           "binary catchment major %ld\n", N_CATCHMENTS, n_steps, n_wrong_csv, n_wrong_time, n_wrong_catchment);
+    n_failed += (n_wrong_csv + n_wrong_time + n_wrong_catchment) > 0;
+
+    // the PET of a run_pet_series as the time and PET of each step of the last catchment
+    pet_model *last = (pet_model *) models[N_CATCHMENTS - 1]->data;
+    double *series = (double *) malloc(n_steps * sizeof(double));
+    double *values = (double *) malloc(2 * n_steps * sizeof(double));
+    long n_wrong_series = 0;
+    pet_output_options options = {PET_OUTPUT_BINARY, PET_OUTPUT_TIME_MAJOR, PET_OUTPUT_TIME | PET_OUTPUT_PET, 1, 0,
+                                  BUFFER_BYTES};
+    last->bmi.current_step = 0;
+    last->bmi.current_time = 0.0;
+    pet_output *series_output = pet_output_open(time_major_file, &options);
+    if (series_output == NULL || run_pet_series(last, n_steps, series) != n_steps ||
+        pet_output_write_series(series_output, 0, expected[(N_CATCHMENTS - 1) * n_steps * PET_OUTPUT_N_FIELDS],
+                                last->bmi.time_step_size_s, n_steps, series) != 0 ||
+        pet_output_close(series_output) != 0)
+        n_wrong_series = n_steps;
+    FILE *fp = fopen(time_major_file, "rb");
+    if (fp == NULL || fread(values, sizeof(double), 2 * n_steps, fp) != (size_t)(2 * n_steps))
+        n_wrong_series = n_steps;
+    if (fp != NULL) fclose(fp);
+    for (long step = 0; step < n_steps && n_wrong_series == 0; step++){
+        const double *record = &expected[((N_CATCHMENTS - 1) * n_steps + step) * PET_OUTPUT_N_FIELDS];
+        n_wrong_series += values[2 * step] != record[0] || values[2 * step + 1] != record[1];
+    }
+    printf(" run_pet_series of %ld steps, values out of place: %ld\n", n_steps, n_wrong_series);
+    n_failed += n_wrong_series > 0;
+    free(series);
+    free(values);
+
+    // a catchment major csv cannot be streamed, and catchments must be in range
+    pet_output *refused = open_output(csv_file, PET_OUTPUT_CSV, PET_OUTPUT_CATCHMENT_MAJOR, csv_fields, n_steps);
+    n_failed += refused != NULL;
+    pet_output *in_range = open_output(csv_file, PET_OUTPUT_CSV, PET_OUTPUT_TIME_MAJOR, csv_fields, n_steps);
+    n_failed += in_range == NULL || pet_output_write(in_range, N_CATCHMENTS, 0.0, models[0]->data) == 0;
+    pet_output_close(in_range);
+
+    for (int c = 0; c < N_CATCHMENTS; c++){
+        models[c]->finalize(models[c]);
+        free(models[c]->data);
+        free(models[c]);
+    }
+    free(expected);
+    remove(csv_file);
+    remove(time_major_file);
+    remove(catchment_major_file);
+
+    if (n_failed > 0){
+        printf("\nOUTPUT UNIT TEST FAILED\n");
+        return BMI_FAILURE;
+    }
+    printf("\n********************\nEND OUTPUT UNIT TEST\n\n");
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/pet.h"
+#include "../include/bmi.h"
+#include "../include/bmi_pet.h"
+
+/*
+    Runs every PET method over the whole forcing file twice, once with a BMI update per timestep and once with
+    run_pet_series (in two pieces, to check that a series run picks up where the last one stopped), and checks
+    that both give identical PET values and end at the same model time.  The series run uses the solar geometry
+    cache and the stepped run does not, so this also checks that the cache does not change the results.
+    usage: run_pet_series_test <config reading forcing from file>
+*/
+int
+main(int argc, const char *argv[]){
+
+    if(argc<=1){
+        printf("\nmust include a configuration that reads forcing from file...exiting\n\n");
+        exit(1);
+    }
+
+    printf("\nBEGIN SERIES UNIT TEST\n**********************\n");
+
+    int n_failed = 0;
+    for (int method = 1; method <= 5; method++){
+        Bmi *stepped_bmi = (Bmi *) malloc(sizeof(Bmi));
+        Bmi *series_bmi  = (Bmi *) malloc(sizeof(Bmi));
+        register_bmi_pet(stepped_bmi);
+        register_bmi_pet(series_bmi);
+        if (stepped_bmi->initialize(stepped_bmi, argv[1]) == BMI_FAILURE) return BMI_FAILURE;
+        if (series_bmi->initialize(series_bmi, argv[1]) == BMI_FAILURE) return BMI_FAILURE;
+        pet_model *stepped = (pet_model *) stepped_bmi->data;
+        pet_model *series  = (pet_model *) series_bmi->data;
+        stepped->pet_method = method;
+        series->pet_method  = method;
+        series->solar_options.cache_solar_geometry = 1;
+        stepped->bmi.verbose = 0;
+        pet_setup(stepped);
+        pet_setup(series);
+
+        long n_steps = series->bmi.num_timesteps;
+        long n_first = n_steps / 3;
+        double *pet_series = (double *) malloc(n_steps * sizeof(double));
+        long n_done = run_pet_series(series, n_first, pet_series);
+        n_done += run_pet_series(series, n_steps, pet_series + n_done);   // runs to the end of the forcing
+
+        long n_different = 0;
+        for (long step = 0; step < n_steps; step++){
+            double expected;
+            stepped_bmi->update(stepped_bmi);
+            stepped_bmi->get_value(stepped_bmi, "water_potential_evaporation_flux", &expected);
+            if (pet_series[step] != expected) n_different++;
+        }
+
+        printf(" method %d: %ld of %ld steps run, %ld differ from BMI update\n", method, n_done, n_steps, n_different);
+        if (n_done != n_steps || n_different > 0 ||
+            series->bmi.current_step != stepped->bmi.current_step ||
+            series->bmi.current_time != stepped->bmi.current_time ||
+            memcmp(&series->solar_results, &stepped->solar_results, sizeof(series->solar_results)) != 0)
+            n_failed++;
+
+        free(pet_series);
+        stepped_bmi->finalize(stepped_bmi);
+        series_bmi->finalize(series_bmi);
+    }
+
+    if (n_failed > 0){
+        printf("\n%d of 5 methods FAILED\n", n_failed);
+        return BMI_FAILURE;
+    }
+    printf("\n********************\nEND SERIES UNIT TEST\n\n");
+    return 0;
+}
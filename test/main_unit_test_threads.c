@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../include/pet.h"
+#include "../include/bmi.h"
+#include "../include/bmi_pet.h"
+
+#define N_INSTANCES 40
+#define N_THREADS   8
+
+/*
+    Stress test of the thread safety contract in pet.h.  Runs N_INSTANCES PET instances (every method, with and
+    without the solar geometry cache) one after the other, then all of them again on N_THREADS threads at once, each
+    instance initialized, stepped through the whole forcing file with BMI update/get_value and finalized by whichever
+    thread picks it up.  Fails unless every PET value of the threaded runs is bitwise identical to the serial run.
+    usage: run_pet_threads_test <config reading forcing from file>
+*/
+
+typedef struct instance_run {
+    const char *config_file;
+    int         pet_method;
+    int         cache_solar_geometry;
+    long        n_steps;
+    double     *pet_m_per_s;
+    int         status;
+} instance_run;
+
+typedef struct instance_pool {
+    instance_run   *runs;
+    long            next_run;
+    pthread_mutex_t lock;
+} instance_pool;
+
+static int run_instance(instance_run *run)
+{
+    Bmi *model = (Bmi *) malloc(sizeof(Bmi));
+    register_bmi_pet(model);
+    if (model->initialize(model, run->config_file) == BMI_FAILURE) return BMI_FAILURE;
+    pet_model *pet = (pet_model *) model->data;
+    pet->pet_method = run->pet_method;
+    pet->solar_options.cache_solar_geometry = run->cache_solar_geometry;
+    pet_setup(pet);
+
+    run->n_steps = pet->bmi.num_timesteps;
+    run->pet_m_per_s = (double *) malloc(run->n_steps * sizeof(double));
+    for (long step = 0; step < run->n_steps; step++){
+        model->update(model);
+        model->get_value(model, "water_potential_evaporation_flux", &run->pet_m_per_s[step]);
+    }
+
+    model->finalize(model);
+    free(model->data);
+    free(model);
+    return BMI_SUCCESS;
+}
+
+static void *instance_worker(void *arg)
+{
+    instance_pool *pool = (instance_pool *) arg;
+    for (;;){
+        pthread_mutex_lock(&pool->lock);
+        long i = pool->next_run++;
+        pthread_mutex_unlock(&pool->lock);
+        if (i >= N_INSTANCES) break;
+        pool->runs[i].status = run_instance(&pool->runs[i]);
+    }
+    return NULL;
+}
+
+int
+main(int argc, const char *argv[]){
+
+    if(argc<=1){
+        printf("\nmust include a configuration that reads forcing from file...exiting\n\n");
+        exit(1);
+    }
+
+    printf("\nBEGIN THREADS UNIT TEST\n***********************\n");
+
+    instance_run serial[N_INSTANCES], threaded[N_INSTANCES];
+    for (int i = 0; i < N_INSTANCES; i++){
+        serial[i].config_file = argv[1];
+        serial[i].pet_method = 1 + i % 5;
+        serial[i].cache_solar_geometry = (i / 5) % 2;
+        threaded[i] = serial[i];
+        if (run_instance(&serial[i]) == BMI_FAILURE) return BMI_FAILURE;
+    }
+
+    instance_pool pool;
+    pool.runs = threaded;
+    pool.next_run = 0;
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_t threads[N_THREADS];
+    for (int t = 0; t < N_THREADS; t++)
+        pthread_create(&threads[t], NULL, instance_worker, &pool);
+    for (int t = 0; t < N_THREADS; t++)
+        pthread_join(threads[t], NULL);
+    pthread_mutex_destroy(&pool.lock);
+
+    int n_failed = 0;
+    for (int i = 0; i < N_INSTANCES; i++){
+        if (threaded[i].status == BMI_FAILURE || threaded[i].n_steps != serial[i].n_steps ||
+            memcmp(threaded[i].pet_m_per_s, serial[i].pet_m_per_s, serial[i].n_steps * sizeof(double)) != 0){
+            printf(" instance %d (method %d) differs between the serial and threaded runs\n", i, serial[i].pet_method);
+            n_failed++;
+        }
+        free(serial[i].pet_m_per_s);
+        if (threaded[i].status != BMI_FAILURE) free(threaded[i].pet_m_per_s);
+    }
+    printf(" %d instances of %ld steps on %d threads, %d differ from the serial run\n",
+           N_INSTANCES, serial[0].n_steps, N_THREADS, n_failed);
+
+    if (n_failed > 0){
+        printf("\nTHREADS UNIT TEST FAILED\n");
+        return BMI_FAILURE;
+    }
+    printf("\n*********************\nEND THREADS UNIT TEST\n\n");
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/pet.h"
+#include "../include/bmi.h"
+#include "../include/bmi_pet.h"
+#include "../include/pet_timing.h"
+
+#define N_METHODS 5
+
+/*
+    Tests the per stage timing of pet_timing.h, built with -DPET_TIMING.  The forcing file of the config is run
+    through BMI update with each PET method, then through run_pet_series.  Every stage must be called once a step
+    exactly when the method goes through it (no net radiation for the aerodynamic method, no intermediate variables
+    for the energy balance method, aerodynamic resistance for Penman Monteith only), with time counted for the stages
+    that ran and none for the others.  The BMI output variables must give the same totals, on a grid of one item per
+    stage.
+    usage: run_pet_timing_test <config reading forcing from file>
+*/
+
+// which stages a step of each method goes through, in pet_timing_stage order
+static const int method_stages[N_METHODS][PET_TIMING_N_STAGES] = {
+    {1, 1, 1, 0, 0, 1},   // energy balance
+    {1, 1, 0, 1, 0, 1},   // aerodynamic
+    {1, 1, 1, 1, 0, 1},   // combination
+    {1, 1, 1, 1, 0, 1},   // Priestley-Taylor
+    {1, 1, 1, 1, 1, 1},   // Penman Monteith
+};
+
+static int check_timing(const struct pet_timing *timing, int method, long n_steps)
+{
+    int wrong = 0;
+    for (int stage = 0; stage < PET_TIMING_N_STAGES; stage++){
+        double calls = method_stages[method - 1][stage] ? (double)n_steps : 0.0;
+        wrong |= timing->calls[stage] != calls;
+        wrong |= (calls > 0.0) ? timing->ns[stage] <= 0.0 : timing->ns[stage] != 0.0;
+        wrong |= timing->ns[stage] < 0.0 || timing->cycles[stage] < 0.0;
+    }
+    return wrong;
+}
+
+int
+main(int argc, const char *argv[]){
+
+    if(argc<=1){
+        printf("\nmust include a configuration that reads forcing from file...exiting\n\n");
+        exit(1);
+    }
+
+    printf("\nBEGIN TIMING UNIT TEST\n**********************\n");
+
+    int n_failed = 0;
+    for (int method = 1; method <= N_METHODS; method++){
+        Bmi *model = (Bmi *) malloc(sizeof(Bmi));
+        register_bmi_pet(model);
+        if (model->initialize(model, argv[1]) == BMI_FAILURE) return BMI_FAILURE;
+        pet_model *pet = (pet_model *) model->data;
+        pet->pet_method = method;
+        pet_setup(pet);
+        long n_steps = pet->bmi.num_timesteps;
+
+        for (long step = 0; step < n_steps; step++)
+            if (model->update(model) == BMI_FAILURE) return BMI_FAILURE;
+        int wrong = check_timing(&pet->timing, method, n_steps);
+
+        // the BMI output variables
+        double ns[PET_TIMING_N_STAGES], cycles[PET_TIMING_N_STAGES], calls[PET_TIMING_N_STAGES];
+        int grid, grid_size, n_outputs;
+        model->get_output_item_count(model, &n_outputs);
+        wrong |= n_outputs != 7;
+        wrong |= model->get_value(model, "pet_stage_time_ns", ns) == BMI_FAILURE ||
+                 model->get_value(model, "pet_stage_cycle_count", cycles) == BMI_FAILURE ||
+                 model->get_value(model, "pet_stage_call_count", calls) == BMI_FAILURE;
+        wrong |= memcmp(ns, pet->timing.ns, sizeof(ns)) != 0 || memcmp(cycles, pet->timing.cycles, sizeof(cycles)) != 0 ||
+                 memcmp(calls, pet->timing.calls, sizeof(calls)) != 0;
+        wrong |= model->get_var_grid(model, "pet_stage_call_count", &grid) == BMI_FAILURE ||
+                 model->get_grid_size(model, grid, &grid_size) == BMI_FAILURE || grid_size != PET_TIMING_N_STAGES;
+        print_pet_timing(pet, pet->forcing_file);
+
+        // again through run_pet_series, from fresh counters
+        pet->bmi.current_step = 0;
+        memset(&pet->timing, 0, sizeof(pet->timing));
+        double *series = (double *) malloc(n_steps * sizeof(double));
+        wrong |= run_pet_series(pet, n_steps, series) != n_steps || check_timing(&pet->timing, method, n_steps);
+        free(series);
+
+        printf(" method %d: %s\n\n", method, wrong ? "FAILED" : "stages counted");
+        n_failed += wrong;
+        memset(&pet->timing, 0, sizeof(pet->timing));  // nothing for Finalize to print
+        model->finalize(model);
+        free(model->data);
+        free(model);
+    }
+
+    if (n_failed > 0){
+        printf("\n%d TIMING UNIT TESTS FAILED\n", n_failed);
+        return BMI_FAILURE;
+    }
+    printf("\n********************\nEND TIMING UNIT TEST\n\n");
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../include/pet.h"
+#include "../include/bmi.h"
+#include "../include/bmi_pet.h"
+
+#define MAX_CATCHMENTS 16
+
+static const char *forcing_names[7] = {
+    "land_surface_radiation~incoming~longwave__energy_flux",
+    "land_surface_radiation~incoming~shortwave__energy_flux",
+    "land_surface_air__pressure",
+    "atmosphere_air_water~vapor__relative_saturation",
+    "land_surface_air__temperature",
+    "land_surface_wind__x_component_of_velocity",
+    "land_surface_wind__y_component_of_velocity"
+};
+
+/*
+    Runs a vector grid instance (catchment_configs in its config) next to one BMI instance per catchment, feeding
+    both the same AORC forcing, and checks the grid functions, that whole arrays and scattered/gathered items go to
+    and come from the right catchments, and that the PET of every catchment agrees at every timestep, as do its
+    daily and cumulative PET depths at the end.
+    usage: run_pet_vector_test <config reading forcing from file> <vector grid config> <config of each catchment>
+*/
+int
+main(int argc, const char *argv[]){
+
+    if(argc<=3){
+        printf("\nmust include a forcing-file configuration, a vector grid configuration and a catchment configuration"
+               "...exiting\n\n");
+        exit(1);
+    }
+
+    printf("\nBEGIN VECTOR UNIT TEST\n**********************\n");
+
+    // One instance just to read the forcing file, the rows are shared out to the catchments below
+    Bmi *reader_bmi = (Bmi *) malloc(sizeof(Bmi));
+    register_bmi_pet(reader_bmi);
+    if (reader_bmi->initialize(reader_bmi, argv[1]) == BMI_FAILURE) return BMI_FAILURE;
+    pet_model *reader = (pet_model *) reader_bmi->data;
+    long n_rows = reader->bmi.num_timesteps;
+    double *rows[7] = {
+        reader->forcing_data_incoming_longwave_W_per_m2,
+        reader->forcing_data_incoming_shortwave_W_per_m2,
+        reader->forcing_data_surface_pressure_Pa,
+        reader->forcing_data_specific_humidity_2m_kg_per_kg,
+        reader->forcing_data_air_temperature_2m_K,
+        reader->forcing_data_u_wind_speed_10m_m_per_s,
+        reader->forcing_data_v_wind_speed_10m_m_per_s
+    };
+
+    Bmi *vector_bmi = (Bmi *) malloc(sizeof(Bmi));
+    register_bmi_pet(vector_bmi);
+    if (vector_bmi->initialize(vector_bmi, argv[2]) == BMI_FAILURE) return BMI_FAILURE;
+
+    // grid functions
+    int grid, size, nbytes;
+    char type[BMI_MAX_TYPE_NAME];
+    vector_bmi->get_var_grid(vector_bmi, "water_potential_evaporation_flux", &grid);
+    vector_bmi->get_grid_size(vector_bmi, grid, &size);
+    vector_bmi->get_grid_type(vector_bmi, grid, type);
+    vector_bmi->get_var_nbytes(vector_bmi, "land_surface_air__temperature", &nbytes);
+    printf(" grid %d: %s of %d catchments, %d bytes per variable\n", grid, type, size, nbytes);
+    if (size < 2 || size > MAX_CATCHMENTS || strcmp(type, "vector") != 0 || nbytes != size * (int)sizeof(double))
+        return BMI_FAILURE;
+    int n_catchments = size;
+
+    Bmi *models[MAX_CATCHMENTS];
+    for (int c = 0; c < n_catchments; c++){
+        models[c] = (Bmi *) malloc(sizeof(Bmi));
+        register_bmi_pet(models[c]);
+        if (models[c]->initialize(models[c], argv[3]) == BMI_FAILURE) return BMI_FAILURE;
+    }
+
+    // the temperature is scattered in reverse order with set_value_at_indices, the rest set as whole arrays
+    int reversed[MAX_CATCHMENTS];
+    for (int c = 0; c < n_catchments; c++)
+        reversed[c] = n_catchments - 1 - c;
+
+    double max_rel_diff = 0.0;
+    long n_misplaced = 0;
+    for (long step = 0; step < n_rows; step++){
+        for (int v = 0; v < 7; v++){
+            double values[MAX_CATCHMENTS];
+            for (int c = 0; c < n_catchments; c++){
+                // offset each catchment into a different part of the forcing record
+                long row = (step + c * n_rows / n_catchments) % n_rows;
+                values[c] = rows[v][row];
+                models[c]->set_value(models[c], forcing_names[v], &values[c]);
+            }
+            if (strcmp(forcing_names[v], "land_surface_air__temperature") == 0){
+                double scattered[MAX_CATCHMENTS];
+                for (int c = 0; c < n_catchments; c++)
+                    scattered[c] = values[reversed[c]];
+                vector_bmi->set_value_at_indices(vector_bmi, forcing_names[v], reversed, n_catchments, scattered);
+            }
+            else
+                vector_bmi->set_value(vector_bmi, forcing_names[v], values);
+
+            // the array behind get_value_ptr must hold catchment c at item c
+            double *items;
+            vector_bmi->get_value_ptr(vector_bmi, forcing_names[v], (void**)&items);
+            for (int c = 0; c < n_catchments; c++)
+                if (items[c] != values[c]) n_misplaced++;
+        }
+
+        vector_bmi->update(vector_bmi);
+
+        double pet[MAX_CATCHMENTS], gathered[MAX_CATCHMENTS];
+        vector_bmi->get_value(vector_bmi, "water_potential_evaporation_flux", pet);
+        vector_bmi->get_value_at_indices(vector_bmi, "water_potential_evaporation_flux", gathered, reversed,
+                                         n_catchments);
+        for (int c = 0; c < n_catchments; c++){
+            double expected, rel_diff;
+            models[c]->update(models[c]);
+            models[c]->get_value(models[c], "water_potential_evaporation_flux", &expected);
+            rel_diff = fabs(pet[c] - expected) / fmax(fabs(expected), 1.0e-20);
+            if (rel_diff > max_rel_diff) max_rel_diff = rel_diff;
+            if (gathered[c] != pet[reversed[c]]) n_misplaced++;
+        }
+    }
+
+    // the depths Update adds up, on both sides
+    const char *depth_names[2] = {"water_potential_evaporation_depth_daily",
+                                  "water_potential_evaporation_depth_cumulative"};
+    for (int d = 0; d < 2; d++){
+        double depth[MAX_CATCHMENTS];
+        vector_bmi->get_value(vector_bmi, depth_names[d], depth);
+        for (int c = 0; c < n_catchments; c++){
+            double expected, rel_diff;
+            models[c]->get_value(models[c], depth_names[d], &expected);
+            rel_diff = (expected > 0.0) ? fabs(depth[c] - expected) / expected : 1.0;  // a day must have passed
+            if (rel_diff > max_rel_diff) max_rel_diff = rel_diff;
+        }
+    }
+
+    double vector_time, model_time;
+    vector_bmi->get_current_time(vector_bmi, &vector_time);
+    models[0]->get_current_time(models[0], &model_time);
+    printf(" %ld steps x %d catchments, max relative difference vector grid vs. BMI %e, %ld items misplaced\n",
+           n_rows, n_catchments, max_rel_diff, n_misplaced);
+
+    for (int c = 0; c < n_catchments; c++)
+        models[c]->finalize(models[c]);
+    vector_bmi->finalize(vector_bmi);
+    reader_bmi->finalize(reader_bmi);
+
+    if (max_rel_diff > 1.0e-12 || n_misplaced > 0 || vector_time != model_time){
+        printf("\nVECTOR UNIT TEST FAILED\n");
+        return BMI_FAILURE;
+    }
+    printf("\n********************\nEND VECTOR UNIT TEST\n\n");
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/pet.h"
+#include "../include/bmi.h"
+#include "../include/bmi_pet.h"
+#include "../include/pet_forcing.h"
+
+#define N_WINDOWS 4
+
+/*
+    Tests the streamed forcing of pet_forcing.h.  The forcing file of the config, and a binary copy of it written
+    here, are run through BMI update with the whole file loaded and then with forcing_window_steps of 1, 7, 24 and
+    more than the run, for num_timesteps equal to the rows of the file and for more (the last row repeated), each
+    read in line and with forcing_prefetch.  Every windowed run must give bitwise the same PET as the whole file,
+    through update and through run_pet_series, and must hold no more than its window.  A window moved back to the
+    start after a run must read the same rows again.
+    usage: run_pet_window_test <config reading forcing from file> <scratch binary forcing file>
+*/
+
+static const long window_steps[N_WINDOWS] = {1, 7, 24, 100000};
+
+// the config with some keys added, the last value of a key in a config is the one used
+static int write_config(const char *config_file, const char *scratch_config, const char *forcing_file,
+                        long num_timesteps, long forcing_window_steps, int forcing_prefetch)
+{
+    char line[1024];
+    FILE *in = fopen(config_file, "r"), *out = fopen(scratch_config, "w");
+    if (in == NULL || out == NULL) return BMI_FAILURE;
+    while (fgets(line, sizeof(line), in) != NULL)
+        fputs(line, out);
+    fprintf(out, "\nforcing_file=%s\nnum_timesteps=%ld\nforcing_window_steps=%ld\nforcing_prefetch=%d\n",
+            forcing_file, num_timesteps, forcing_window_steps, forcing_prefetch);
+    fclose(in);
+    return fclose(out) == 0 ? BMI_SUCCESS : BMI_FAILURE;
+}
+
+// PET of every step through BMI update, and through run_pet_series (in two pieces) when series is not NULL
+static int run_forcing(const char *scratch_config, long n_steps, double *updated, double *series, long *max_rows)
+{
+    Bmi *model = (Bmi *) malloc(sizeof(Bmi));
+    register_bmi_pet(model);
+    if (model->initialize(model, scratch_config) == BMI_FAILURE) return BMI_FAILURE;
+    pet_model *pet = (pet_model *) model->data;
+    *max_rows = pet->forcing_block.n_rows;
+    for (long step = 0; step < n_steps; step++){
+        if (model->update(model) == BMI_FAILURE) return BMI_FAILURE;
+        model->get_value(model, "water_potential_evaporation_flux", &updated[step]);
+        if (pet->forcing_block.n_rows > *max_rows) *max_rows = pet->forcing_block.n_rows;
+    }
+    if (series != NULL){
+        // back to the start, the window has to go back too
+        pet->bmi.current_step = 0;
+        long n_done = run_pet_series(pet, n_steps / 3, series);
+        n_done += run_pet_series(pet, n_steps, series + n_done);
+        if (n_done != n_steps) return BMI_FAILURE;
+    }
+    model->finalize(model);
+    free(model->data);
+    free(model);
+    return BMI_SUCCESS;
+}
+
+int
+main(int argc, const char *argv[]){
+
+    if(argc<=2){
+        printf("\nmust include a configuration that reads forcing from file and a scratch file name...exiting\n\n");
+        exit(1);
+    }
+
+    printf("\nBEGIN WINDOW UNIT TEST\n**********************\n");
+
+    // binary copy of the forcing file
+    Bmi *source_bmi = (Bmi *) malloc(sizeof(Bmi));
+    register_bmi_pet(source_bmi);
+    if (source_bmi->initialize(source_bmi, argv[1]) == BMI_FAILURE) return BMI_FAILURE;
+    pet_model *source = (pet_model *) source_bmi->data;
+    char csv_file[1024];
+    snprintf(csv_file, sizeof(csv_file), "%s", source->forcing_file);
+    long n_file_rows = source->bmi.num_timesteps;
+    if (write_forcing_binary_pet(source, argv[2]) != 0) return BMI_FAILURE;
+    source_bmi->finalize(source_bmi);
+    free(source_bmi->data);
+    free(source_bmi);
+
+    char scratch_config[1024];
+    snprintf(scratch_config, sizeof(scratch_config), "%s.config", argv[2]);
+    const char *forcing_files[2] = {csv_file, argv[2]};
+    const long n_steps_run[2] = {n_file_rows, n_file_rows + n_file_rows / 3};
+
+    int n_failed = 0;
+    for (int f = 0; f < 2; f++){
+        for (int r = 0; r < 2; r++){
+            long n_steps = n_steps_run[r], max_rows;
+            double *expected = (double *) malloc(n_steps * sizeof(double));
+            double *updated  = (double *) malloc(n_steps * sizeof(double));
+            double *series   = (double *) malloc(n_steps * sizeof(double));
+
+            if (write_config(argv[1], scratch_config, forcing_files[f], n_steps, 0, 0) == BMI_FAILURE) return BMI_FAILURE;
+            if (run_forcing(scratch_config, n_steps, expected, NULL, &max_rows) == BMI_FAILURE) return BMI_FAILURE;
+
+            for (int w = 0; w < 2 * N_WINDOWS; w++){
+                long window = window_steps[w / 2];
+                int prefetch = w % 2;
+                if (write_config(argv[1], scratch_config, forcing_files[f], n_steps, window, prefetch) == BMI_FAILURE ||
+                    run_forcing(scratch_config, n_steps, updated, series, &max_rows) == BMI_FAILURE){
+                    printf(" %s, window of %ld: run failed\n", f ? "binary" : "csv", window);
+                    n_failed++;
+                    continue;
+                }
+                int differ = memcmp(updated, expected, n_steps * sizeof(double)) != 0 ||
+                             memcmp(series, expected, n_steps * sizeof(double)) != 0 ||
+                             max_rows > window;
+                printf(" %-6s %4ld steps, window of %6ld%-9s: %4ld rows held, %s\n", f ? "binary" : "csv", n_steps,
+                       window, prefetch ? " prefetch" : "", max_rows, differ ? "FAILED" : "same PET");
+                n_failed += differ;
+            }
+            free(expected);
+            free(updated);
+            free(series);
+        }
+    }
+    remove(scratch_config);
+    remove(argv[2]);
+
+    if (n_failed > 0){
+        printf("\n%d WINDOW UNIT TESTS FAILED\n", n_failed);
+        return BMI_FAILURE;
+    }
+    printf("\n********************\nEND WINDOW UNIT TEST\n\n");
+    return 0;
+}
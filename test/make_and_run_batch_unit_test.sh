@@ -0,0 +1,5 @@
+#!/bin/bash
+# CFLAGS, e.g. "-mavx2 -mfma", selects the vector kernels of pet_simd.c that are checked
+gcc $CFLAGS ./main_unit_test_batch.c ../src/bmi_pet.c ../src/pet_forcing.c ../src/pet.c ../src/pet_arena.c ../src/pet_batch.c ../src/pet_simd.c -lm -o run_pet_batch_test
+# the forcing file in the config is relative to the top of the repository
+cd .. && ./test/run_pet_batch_test ./configs/pet_config_cat_67.txt ./configs/pet_config_bmi.txt
@@ -1,4 +1,4 @@
 #!/bin/bash
-gcc ./main_unit_test_bmi.c ../src/bmi_pet.c ../src/pet.c -lm -o run_pet_bmi_test
+gcc ./main_unit_test_bmi.c ../src/bmi_pet.c ../src/pet_forcing.c ../src/pet.c ../src/pet_arena.c ../src/pet_batch.c ../src/pet_simd.c -lm -o run_pet_bmi_test
 ./run_pet_bmi_test ../configs/pet_config_bmi_unit_test.txt
 #./run_pet_bmi_test ../configs/pet_config_cat_67.txt
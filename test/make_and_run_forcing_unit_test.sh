@@ -0,0 +1,3 @@
+#!/bin/bash
+gcc ./main_unit_test_forcing.c ../src/pet_forcing.c ../src/pet_arena.c -lm -o run_pet_forcing_test
+./run_pet_forcing_test ../forcing/cat-67_2015.csv ./forcing_unit_test.bin
@@ -0,0 +1,8 @@
+#!/bin/bash
+SOURCES="../src/bmi_pet.c ../src/pet_forcing.c ../src/pet.c ../src/pet_arena.c ../src/pet_batch.c ../src/pet_simd.c"
+# every verbose level built, and none
+gcc ./main_unit_test_log.c $SOURCES -lm -o run_pet_log_test
+gcc -DPET_LOG_MAX_LEVEL=0 ./main_unit_test_log.c $SOURCES -lm -o run_pet_log_quiet_test
+# the forcing file in the config is relative to the top of the repository
+cd .. && ./test/run_pet_log_test ./configs/pet_config_cat_67.txt ./test/log_unit_test && \
+         ./test/run_pet_log_quiet_test ./configs/pet_config_cat_67.txt ./test/log_unit_test
@@ -0,0 +1,4 @@
+#!/bin/bash
+gcc -DPET_TIMING ./main_unit_test_timing.c ../src/bmi_pet.c ../src/pet_forcing.c ../src/pet.c ../src/pet_arena.c ../src/pet_batch.c ../src/pet_simd.c -lm -o run_pet_timing_test
+# the forcing file in the config is relative to the top of the repository
+cd .. && ./test/run_pet_timing_test ./configs/pet_config_cat_67.txt
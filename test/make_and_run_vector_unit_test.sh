@@ -0,0 +1,4 @@
+#!/bin/bash
+gcc ./main_unit_test_vector.c ../src/bmi_pet.c ../src/pet_forcing.c ../src/pet.c ../src/pet_arena.c ../src/pet_batch.c ../src/pet_simd.c -lm -o run_pet_vector_test
+# the forcing file and catchment configs are relative to the top of the repository
+cd .. && ./test/run_pet_vector_test ./configs/pet_config_cat_67.txt ./configs/pet_config_vector.txt ./configs/pet_config_bmi.txt
@@ -0,0 +1,5 @@
+#!/bin/bash
+# PET_FORCING_PREFETCH builds the prefetch thread, as CMake does
+gcc -DPET_FORCING_PREFETCH ./main_unit_test_window.c ../src/bmi_pet.c ../src/pet_forcing.c ../src/pet.c ../src/pet_arena.c ../src/pet_batch.c ../src/pet_simd.c -lm -pthread -o run_pet_window_test
+# the forcing file in the config is relative to the top of the repository
+cd .. && ./test/run_pet_window_test ./configs/pet_config_cat_67.txt ./test/window_unit_test.bin